@@ -0,0 +1,71 @@
+#include "stdafx.h"
+#include "AgentArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+const size_t AgentArena::DefaultCapacity;
+
+void AgentArena::Reserve(size_t capacity)
+{
+	if (m_pBlock || capacity == 0)
+		return;
+
+	AddBlock(capacity);
+}
+
+void AgentArena::Release()
+{
+	for (auto pDestructor = m_pDestructors; pDestructor; pDestructor = pDestructor->pNext)
+		pDestructor->Destroy(pDestructor->pObject);
+	m_pDestructors = nullptr;
+
+	while (m_pBlock)
+	{
+		const auto pPrevious = m_pBlock->pPrevious;
+		free(m_pBlock);
+		m_pBlock = pPrevious;
+	}
+	m_Offset = 0;
+	m_Used = 0;
+}
+
+size_t AgentArena::BlockCount() const
+{
+	size_t count = 0;
+	for (auto pBlock = m_pBlock; pBlock; pBlock = pBlock->pPrevious)
+		++count;
+	return count;
+}
+
+void* AgentArena::Allocate(size_t size, size_t alignment)
+{
+	//Worst case padding, so a Reserve of Used always fits whatever the block address
+	m_Used += size + alignment - 1;
+
+	if (m_pBlock)
+	{
+		const auto data = reinterpret_cast<uintptr_t>(m_pBlock + 1);
+		const auto address = (data + m_Offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+		if (address + size <= data + m_pBlock->Capacity)
+		{
+			m_Offset = address + size - data;
+			return reinterpret_cast<void*>(address);
+		}
+	}
+
+	AddBlock(std::max(size + alignment - 1, DefaultCapacity));
+	const auto data = reinterpret_cast<uintptr_t>(m_pBlock + 1);
+	const auto address = (data + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	m_Offset = address + size - data;
+	return reinterpret_cast<void*>(address);
+}
+
+void AgentArena::AddBlock(size_t capacity)
+{
+	const auto pBlock = static_cast<Block*>(malloc(sizeof(Block) + capacity));
+	pBlock->pPrevious = m_pBlock;
+	pBlock->Capacity = capacity;
+	m_pBlock = pBlock;
+	m_Offset = 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "stdafx.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * AGENT ARENA
+ * Owns the objects an agent is made of: its steering behaviours, pipeline parts, blackboard and tree
+ * They're constructed one after the other in one block, and destroyed together, newest first, when it's released
+ * Reserve enough before the first one and the whole agent is one allocation, whatever doesn't fit gets a block of its own
+ */
+class AgentArena final
+{
+public:
+	static const size_t DefaultCapacity = 4 * 1024;
+
+	AgentArena() = default;
+	~AgentArena() { Release(); }
+
+	AgentArena(const AgentArena&) = delete;
+	AgentArena& operator=(const AgentArena&) = delete;
+
+	//Only does something before the first object, 0 leaves it to the first object
+	void Reserve(size_t capacity);
+
+	template<typename T, typename... Args>
+	T* New(Args&&... args)
+	{
+		const auto pObject = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		if (!std::is_trivially_destructible<T>::value)
+		{
+			const auto pDestructor = static_cast<Destructor*>(Allocate(sizeof(Destructor), alignof(Destructor)));
+			pDestructor->Destroy = &DestroyObject<T>;
+			pDestructor->pObject = pObject;
+			pDestructor->pNext = m_pDestructors;
+			m_pDestructors = pDestructor;
+		}
+		return pObject;
+	}
+
+	//Destroys every object, newest first, and frees the blocks
+	void Release();
+
+	//Bytes a Reserve needs so everything so far would have fit in one block
+	size_t Used() const { return m_Used; }
+	size_t BlockCount() const;
+
+private:
+	struct Block
+	{
+		Block* pPrevious;
+		size_t Capacity;	//Of the bytes after the header
+	};
+	struct Destructor
+	{
+		void (*Destroy)(void*);
+		void* pObject;
+		Destructor* pNext;
+	};
+
+	template<typename T>
+	static void DestroyObject(void* pObject) { static_cast<T*>(pObject)->~T(); }
+
+	void* Allocate(size_t size, size_t alignment);
+	void AddBlock(size_t capacity);
+
+	Block* m_pBlock = nullptr;	//Newest block, the others hang off it
+	size_t m_Offset = 0;	//In the newest block
+	size_t m_Used = 0;	//Over every block, with the padding
+	Destructor* m_pDestructors = nullptr;	//Newest object first
+};
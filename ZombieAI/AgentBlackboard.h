@@ -0,0 +1,224 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include "Blackboard.h"
+#include "ItemStore.h"
+#include "HouseRegistry.h"
+#include "InventoryIndex.h"
+#include "AgentHost.h"
+#include "AI/SteeringBehaviours/SteeringBehaviours.h"
+
+#pragma region VALUES
+//Health and energy in whole points, and where they stand against the thresholds the stats conditions check
+//Only changes when a point is gained or lost or a threshold is crossed, so conditions on it don't fire every time energy drains a little
+//The one place the tree reads health and energy from, see MeasureVitals
+struct AgentVitals
+{
+	int Health = 0;
+	int Energy = 0;
+	bool HealthCritical = false;
+	bool EnergyCritical = false;
+	bool HealthFull = false;
+	bool EnergyFull = false;
+
+	bool operator==(const AgentVitals& other) const
+	{
+		return Health == other.Health && Energy == other.Energy
+			&& HealthCritical == other.HealthCritical && EnergyCritical == other.EnergyCritical
+			&& HealthFull == other.HealthFull && EnergyFull == other.EnergyFull;
+	}
+	bool operator!=(const AgentVitals& other) const { return !(*this == other); }
+};
+#pragma endregion
+
+#pragma region ENTRIES
+/*
+ * Every entry on the agent blackboard, declared once with its type
+ * Each entry becomes a fixed slot, so a lookup is a direct member access instead of a string hash and a runtime type check
+ */
+#define AGENT_BLACKBOARD_ENTRIES(ENTRY) \
+	ENTRY(Host, IAgentHost*) \
+	ENTRY(WanderBehaviour, SteeringBehaviours::Wander*) \
+	ENTRY(SeekBehaviour, SteeringBehaviours::Seek*) \
+	ENTRY(LookAroundBehaviour, SteeringBehaviours::LookAround*) \
+	ENTRY(ArriveBehaviour, SteeringBehaviours::Arrive*) \
+	ENTRY(CurrentBehaviour, SteeringBehaviours::ISteeringBehaviour*) \
+	ENTRY(Target, b2Vec2) \
+	ENTRY(WorldInfo, const WorldInfo*) \
+	ENTRY(AgentInfo, AgentInfo) \
+	ENTRY(Vitals, AgentVitals) \
+	ENTRY(LastDiscovery, float) \
+	ENTRY(HouseLocations, HouseRegistry) \
+	ENTRY(CurrentHouse, HouseHandle) \
+	ENTRY(HouseEntrance, b2Vec2) \
+	ENTRY(Items, ItemStore) \
+	ENTRY(TargetItem, TargetItem) \
+	ENTRY(Inventory, InventoryIndex) \
+	ENTRY(Enemies, vector<EntityInfo>) \
+	ENTRY(EnemySightings, uint32_t)
+#pragma endregion
+
+#pragma region SLOTS
+//Slot index of every entry, in declaration order
+enum class BlackboardSlot : size_t
+{
+#define BLACKBOARD_SLOT(name, type) name,
+	AGENT_BLACKBOARD_ENTRIES(BLACKBOARD_SLOT)
+#undef BLACKBOARD_SLOT
+	Count
+};
+
+//One bit per slot, to track which entries changed
+typedef uint64_t BlackboardSlotMask;
+static_assert(static_cast<size_t>(BlackboardSlot::Count) <= 64, "Blackboard slots don't fit in a BlackboardSlotMask");
+
+//Storage for every entry, one member per slot
+struct AgentBlackboardData
+{
+#define BLACKBOARD_MEMBER(name, type) type m_##name{};
+	AGENT_BLACKBOARD_ENTRIES(BLACKBOARD_MEMBER)
+#undef BLACKBOARD_MEMBER
+};
+#pragma endregion
+
+#pragma region KEYS
+//A key carries its slot and its value type, so using a key with the wrong type is a compile error
+template<BlackboardSlot S, typename T, T AgentBlackboardData::* Member>
+struct BlackboardKey
+{
+	using Type = T;
+	static constexpr size_t Index = static_cast<size_t>(S);
+};
+
+namespace Keys
+{
+#define BLACKBOARD_KEY(name, type) \
+	static constexpr BlackboardKey<BlackboardSlot::name, decltype(AgentBlackboardData::m_##name), &AgentBlackboardData::m_##name> name{};
+	AGENT_BLACKBOARD_ENTRIES(BLACKBOARD_KEY)
+#undef BLACKBOARD_KEY
+}
+
+//Mask of the slots behind a set of keys: SlotMask(Keys::Vitals, Keys::CurrentHouse)
+inline constexpr BlackboardSlotMask SlotMask()
+{
+	return 0;
+}
+template<typename Key, typename... Rest>
+inline constexpr BlackboardSlotMask SlotMask(Key, Rest... rest)
+{
+	return (BlackboardSlotMask(1) << Key::Index) | SlotMask(rest...);
+}
+#pragma endregion
+
+#pragma region BORROW
+//Scoped mutable access to an entry, changes are made in place
+//Only lives as long as the scope that borrowed it, don't hold on to it across ticks
+//Borrowing counts as a change, so only borrow when you're going to change something
+template<typename T>
+class BlackboardBorrow final
+{
+public:
+	explicit BlackboardBorrow(T& data) : m_Data(data) {}
+	BlackboardBorrow(BlackboardBorrow&& other) : m_Data(other.m_Data) {}
+
+	BlackboardBorrow(const BlackboardBorrow&) = delete;
+	BlackboardBorrow& operator=(const BlackboardBorrow&) = delete;
+	BlackboardBorrow& operator=(BlackboardBorrow&&) = delete;
+
+	T& operator*() const { return m_Data; }
+	T* operator->() const { return &m_Data; }
+
+private:
+	T& m_Data;
+};
+#pragma endregion
+
+#pragma region AGENTBLACKBOARD
+//Blackboard with typed, compile-time resolved entries
+//Still a Blackboard, so it can be handed to the behaviour tree and every leaf as before
+class AgentBlackboard final : public Blackboard
+{
+public:
+	using Blackboard::GetData;
+	using Blackboard::ChangeData;
+
+	//The behaviour tree only passes the base pointer to its leaves
+	static AgentBlackboard* From(Blackboard* pBlackboard)
+	{
+		return static_cast<AgentBlackboard*>(pBlackboard);
+	}
+
+	template<BlackboardSlot S, typename T, T AgentBlackboardData::* Member>
+	bool GetData(BlackboardKey<S, T, Member>, T& data) const
+	{
+		data = m_Data.*Member;
+		return true;
+	}
+
+	template<BlackboardSlot S, typename T, T AgentBlackboardData::* Member>
+	bool ChangeData(BlackboardKey<S, T, Member> key, const T& data)
+	{
+		m_Data.*Member = data;
+		MarkChanged(key);
+		return true;
+	}
+
+	//Move the new value in, containers hand over their storage instead of being copied
+	template<BlackboardSlot S, typename T, T AgentBlackboardData::* Member>
+	bool ChangeData(BlackboardKey<S, T, Member> key, T&& data)
+	{
+		m_Data.*Member = std::move(data);
+		MarkChanged(key);
+		return true;
+	}
+
+	//Read-only access to an entry without copying it
+	template<BlackboardSlot S, typename T, T AgentBlackboardData::* Member>
+	const T& View(BlackboardKey<S, T, Member>) const
+	{
+		return m_Data.*Member;
+	}
+
+	//Mutable access to an entry for the current scope
+	template<BlackboardSlot S, typename T, T AgentBlackboardData::* Member>
+	BlackboardBorrow<T> Borrow(BlackboardKey<S, T, Member> key)
+	{
+		MarkChanged(key);
+		return BlackboardBorrow<T>(m_Data.*Member);
+	}
+
+	//Slots changed since the last ClearChanges
+	BlackboardSlotMask GetChanges() const { return m_ChangedSlots; }
+	void ClearChanges() { m_ChangedSlots = 0; }
+
+	//Goes up every time the entry is changed or borrowed, never goes back
+	template<BlackboardSlot S, typename T, T AgentBlackboardData::* Member>
+	uint32_t GetVersion(BlackboardKey<S, T, Member>) const
+	{
+		return m_Versions[static_cast<size_t>(S)];
+	}
+	//Sum of the versions of every slot in the mask, so it goes up whenever one of them changes
+	uint64_t GetVersion(BlackboardSlotMask slots) const
+	{
+		uint64_t version = 0;
+		for (size_t slot = 0; slots != 0; ++slot, slots >>= 1)
+		{
+			if (slots & 1)
+				version += m_Versions[slot];
+		}
+		return version;
+	}
+
+private:
+	template<typename Key>
+	void MarkChanged(Key)
+	{
+		m_ChangedSlots |= SlotMask(Key());
+		++m_Versions[Key::Index];
+	}
+
+	AgentBlackboardData m_Data;
+	BlackboardSlotMask m_ChangedSlots = 0;
+	uint32_t m_Versions[static_cast<size_t>(BlackboardSlot::Count)] = {};
+};
+#pragma endregion
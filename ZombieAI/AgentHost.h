@@ -0,0 +1,91 @@
+#pragma once
+#include "stdafx.h"
+#include "FrameArena.h"
+#include "PathPointCache.h"
+
+/*
+ * AGENT HOST
+ * Everything an agent asks of the world it lives in: its own info, what it sees, its inventory and the navmesh
+ * The plugin only ever has one agent, a population needs one host per agent
+ * Same names as the exam plugin calls, so a leaf reads the same whichever host it runs on
+ */
+class IAgentHost
+{
+public:
+	virtual ~IAgentHost() {}
+
+	//Agent and world
+	virtual AgentInfo AGENT_GetInfo() = 0;
+	virtual WorldInfo WORLD_GetInfo() = 0;
+
+	//Field of view
+	virtual vector<HouseInfo> FOV_GetHouses() = 0;
+	virtual vector<EntityInfo> FOV_GetEntities() = 0;
+	//Same, added to a vector of the caller's so it can live in a frame arena
+	//What the population perceives with every frame, every host fills them in without going through a vector of its own where it can
+	virtual void FOV_FillHouses(FrameVector<HouseInfo>& houses) = 0;
+	virtual void FOV_FillEntities(FrameVector<EntityInfo>& entities) = 0;
+
+	//Inventory
+	virtual int INVENTORY_GetCapacity() = 0;
+	virtual bool INVENTORY_GetItem(int slot, ItemInfo& item) = 0;
+	virtual bool INVENTORY_AddItem(int slot, ItemInfo item) = 0;
+	virtual bool INVENTORY_UseItem(int slot) = 0;
+	virtual bool INVENTORY_RemoveItem(int slot) = 0;
+
+	//Items
+	virtual bool ITEM_Grab(EntityInfo entity, ItemInfo& item) = 0;
+	virtual bool ITEM_GetMetadata(ItemInfo item, const string& field, int& value) = 0;
+
+	//Navmesh
+	//Asked every frame the agent steers without anything to avoid, a host keeps the path it planned or the point it was given where it can
+	virtual b2Vec2 NAVMESH_GetClosestPathPoint(b2Vec2 goal) = 0;
+};
+
+#ifndef ZOMBIEAI_STANDALONE
+//Host backed by the exam plugin, for the single agent the framework runs
+class PluginAgentHost final : public IAgentHost
+{
+public:
+	explicit PluginAgentHost(ExamPlugin* pPlugin) : m_pPlugin(pPlugin) {}
+
+	AgentInfo AGENT_GetInfo() override { return m_pPlugin->AGENT_GetInfo(); }
+	WorldInfo WORLD_GetInfo() override { return m_pPlugin->WORLD_GetInfo(); }
+
+	vector<HouseInfo> FOV_GetHouses() override { return m_pPlugin->FOV_GetHouses(); }
+	vector<EntityInfo> FOV_GetEntities() override { return m_pPlugin->FOV_GetEntities(); }
+	//The framework only hands its field of view back as a vector it allocates, read in place and copied straight into the arena
+	void FOV_FillHouses(FrameVector<HouseInfo>& houses) override
+	{
+		const auto& fov = m_pPlugin->FOV_GetHouses();
+		houses.insert(houses.end(), fov.begin(), fov.end());
+	}
+	void FOV_FillEntities(FrameVector<EntityInfo>& entities) override
+	{
+		const auto& fov = m_pPlugin->FOV_GetEntities();
+		entities.insert(entities.end(), fov.begin(), fov.end());
+	}
+
+	int INVENTORY_GetCapacity() override { return m_pPlugin->INVENTORY_GetCapacity(); }
+	bool INVENTORY_GetItem(int slot, ItemInfo& item) override { return m_pPlugin->INVENTORY_GetItem(slot, item); }
+	bool INVENTORY_AddItem(int slot, ItemInfo item) override { return m_pPlugin->INVENTORY_AddItem(slot, item); }
+	bool INVENTORY_UseItem(int slot) override { return m_pPlugin->INVENTORY_UseItem(slot); }
+	bool INVENTORY_RemoveItem(int slot) override { return m_pPlugin->INVENTORY_RemoveItem(slot); }
+
+	bool ITEM_Grab(EntityInfo entity, ItemInfo& item) override { return m_pPlugin->ITEM_Grab(entity, item); }
+	bool ITEM_GetMetadata(ItemInfo item, const string& field, int& value) override { return m_pPlugin->ITEM_GetMetadata(item, field, value); }
+
+	//The framework's navmesh only answers the next point, it's asked again when that can have changed
+	b2Vec2 NAVMESH_GetClosestPathPoint(b2Vec2 goal) override
+	{
+		return m_PathPoints.GetClosestPathPoint(m_pPlugin->AGENT_GetInfo().Position, goal,
+			[this](const b2Vec2& point) { return m_pPlugin->NAVMESH_GetClosestPathPoint(point); });
+	}
+
+	const PathPointCache& GetPathPoints() const { return m_PathPoints; }
+
+private:
+	ExamPlugin* m_pPlugin;
+	PathPointCache m_PathPoints;
+};
+#endif
@@ -0,0 +1,153 @@
+#include "stdafx.h"
+#include "AgentPopulation.h"
+#include "AI/BehaviourTree/Behaviours.h"
+
+#include <chrono>
+
+AgentPopulation::AgentPopulation(const WorldInfo& worldInfo)
+	: m_WorldInfo(worldInfo)
+{
+}
+
+AgentPopulation::~AgentPopulation()
+{
+	Clear();
+}
+
+size_t AgentPopulation::Add(IAgentHost* pHost)
+{
+	auto pAgent = new ZombieAgent(pHost);
+	pAgent->Start(&m_WorldInfo);
+
+	m_Agents.push_back(pAgent);
+	m_State.Add();
+	m_FrameBudget.Resize(m_Agents.size());
+	return m_Agents.size() - 1;
+}
+
+void AgentPopulation::Clear()
+{
+	for (auto pAgent : m_Agents)
+		delete pAgent;
+
+	m_Agents.clear();
+	m_State.Clear();
+	m_FrameBudget.Clear();
+}
+
+void AgentPopulation::Update(float dt, vector<PluginOutput>& outputs)
+{
+	outputs.resize(m_Agents.size());
+
+#pragma region Perception
+	//Fetch every agent from its host, with the houses and entities in view
+	ForEachAgent([this](size_t i)
+	{
+		auto pHost = m_Agents[i]->GetHost();
+		const auto agentInfo = pHost->AGENT_GetInfo();
+		m_State.Infos[i] = agentInfo;
+		m_State.Health[i] = agentInfo.Health;
+		m_State.Energy[i] = agentInfo.Energy;
+
+		//Only needed until the agent took in what's new, the arena has them
+		auto& arena = m_Agents[i]->GetFrameArena();
+		auto houses = arena.Vector<HouseInfo>();
+		auto entities = arena.Vector<EntityInfo>();
+		pHost->FOV_FillHouses(houses);
+		pHost->FOV_FillEntities(entities);
+		m_Agents[i]->Perceive(agentInfo, houses, entities);
+	});
+#pragma endregion
+
+#pragma region Stats
+	//Vitals only go to the blackboard when they changed
+	ForEachAgent([this](size_t i)
+	{
+		const auto vitals = MeasureVitals(m_State.Health[i], m_State.Energy[i]);
+		if (vitals == m_State.Vitals[i])
+			return;
+
+		m_State.Vitals[i] = vitals;
+		m_Agents[i]->ChangeVitals(vitals);
+	});
+#pragma endregion
+
+#pragma region LevelOfDetail
+	//Only the agents that fit in the budget think and steer, the clock runs from here to the end of the steering
+	const auto tickStart = std::chrono::steady_clock::now();
+	ForEachAgent([this](size_t i)
+	{
+		m_State.Lods[i] = m_Agents[i]->GetLod(m_State.Infos[i]);
+	});
+	m_FrameBudget.Plan(m_State.Lods, m_State.Ticked);
+#pragma endregion
+
+#pragma region BehaviourTree
+	ForEachAgent([this](size_t i)
+	{
+		if (m_State.Ticked[i])
+			m_Agents[i]->Think();
+	});
+#pragma endregion
+
+#pragma region Steering
+	if (m_BatchSteering && m_SteeringBatch.Size() != m_Agents.size())
+		m_SteeringBatch.Resize(m_Agents.size());
+
+	//Steer with the behaviour and target the tree picked
+	//Agents the kernels can steer only fill in their lane here
+	ForEachAgent([this, dt, &outputs](size_t i)
+	{
+		m_State.SteeredBatched[i] = 0;
+		if (!m_State.Ticked[i])
+		{
+			outputs[i] = m_State.Outputs[i];
+			return;
+		}
+
+		const auto pAgent = m_Agents[i];
+		const auto pBoard = pAgent->GetBlackboard();
+		m_State.Behaviours[i] = pBoard->View(Keys::CurrentBehaviour);
+		m_State.Targets[i] = pBoard->View(Keys::Target);
+
+		float slowRadius = 0.f;
+		m_State.SteeredBatched[i] = m_BatchSteering && pAgent->CanSteerBatched(m_State.Behaviours[i], slowRadius);
+		if (m_State.SteeredBatched[i])
+		{
+			//Same way around the walls the pipeline would go
+			const auto& agentInfo = m_State.Infos[i];
+			const auto pathPoint = pAgent->GetHost()->NAVMESH_GetClosestPathPoint(m_State.Targets[i]);
+			m_SteeringBatch.Set(i, agentInfo.Position, pathPoint, agentInfo.MaxLinearSpeed, slowRadius);
+			return;
+		}
+
+		outputs[i] = pAgent->Steer(dt, m_State.Infos[i], m_State.Behaviours[i], m_State.Targets[i]);
+		m_State.Outputs[i] = outputs[i];
+	});
+
+	if (m_BatchSteering)
+	{
+		//Pure arithmetic on a few floats per agent, not worth handing out to the scheduler
+		SteeringKernels::Arrive(m_SteeringBatch, 0, m_SteeringBatch.Size());
+
+		ForEachAgent([this, &outputs](size_t i)
+		{
+			if (!m_State.SteeredBatched[i])
+				return;
+
+			outputs[i] = m_Agents[i]->SteerBatched(m_SteeringBatch.GetLinear(i));
+			m_State.Outputs[i] = outputs[i];
+		});
+	}
+
+	m_FrameBudget.Finish(std::chrono::duration<double>(std::chrono::steady_clock::now() - tickStart).count());
+#pragma endregion
+
+#pragma region EndFrame
+	//Nothing from this frame is needed anymore
+	ForEachAgent([this](size_t i)
+	{
+		m_Agents[i]->GetFrameArena().Reset();
+	});
+#pragma endregion
+}
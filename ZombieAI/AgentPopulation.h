@@ -0,0 +1,134 @@
+#pragma once
+#include "stdafx.h"
+#include "AgentHost.h"
+#include "ZombieAgent.h"
+#include "TaskScheduler.h"
+#include "SteeringKernels.h"
+#include "FrameBudget.h"
+
+#pragma region STATE
+//Hot state of every agent, one array per field
+//Every step of the update only walks the fields it needs, agent after agent
+struct AgentStateBuffers
+{
+	vector<AgentInfo> Infos;	//Whole info as the host gave it, the steering pipeline wants all of it
+	vector<float> Health;
+	vector<float> Energy;
+	vector<AgentVitals> Vitals;
+	vector<b2Vec2> Targets;
+	vector<SteeringBehaviours::ISteeringBehaviour*> Behaviours;
+	vector<uint8_t> SteeredBatched;	//Steered by the kernels this frame instead of the pipeline
+	vector<AgentLod> Lods;
+	vector<uint8_t> Ticked;	//Got its tree and steering this frame, the others reuse their last output
+	vector<PluginOutput> Outputs;	//Of the last tick
+
+	size_t Size() const { return Infos.size(); }
+
+	void Add()
+	{
+		Infos.push_back(AgentInfo());
+		Health.push_back(0.f);
+		Energy.push_back(0.f);
+		Vitals.push_back(AgentVitals());
+		Targets.push_back(b2Vec2_zero);
+		Behaviours.push_back(nullptr);
+		SteeredBatched.push_back(0);
+		Lods.push_back(AgentLod::Critical);
+		Ticked.push_back(0);
+		Outputs.push_back(PluginOutput());
+	}
+
+	void Clear()
+	{
+		Infos.clear();
+		Health.clear();
+		Energy.clear();
+		Vitals.clear();
+		Targets.clear();
+		Behaviours.clear();
+		SteeredBatched.clear();
+		Lods.clear();
+		Ticked.clear();
+		Outputs.clear();
+	}
+};
+#pragma endregion
+
+#pragma region POPULATION
+/*
+ * AGENT POPULATION
+ * Any number of independent agents in one process, each living in its own host
+ * An update runs every agent through perception, stats, the behaviour tree and steering in separate passes
+ * With a scheduler every pass is spread over its threads, the outputs don't depend on how many there are
+ * With a frame budget, only the agents it picks get the tree and steering passes, the others keep their last output
+ * Every agent's frame arena is reset at the end of the update
+ */
+class AgentPopulation final
+{
+public:
+	//Every agent lives in the same world, they all share this one
+	explicit AgentPopulation(const WorldInfo& worldInfo);
+	~AgentPopulation();
+
+	AgentPopulation(const AgentPopulation&) = delete;
+	AgentPopulation& operator=(const AgentPopulation&) = delete;
+
+	//Starts a new agent in the given host, the host isn't owned and has to outlive the agent
+	//Returns the index of the agent
+	size_t Add(IAgentHost* pHost);
+
+	//Removes every agent
+	void Clear();
+
+	//Spread the passes over the threads of the scheduler, nullptr runs them on the calling thread
+	//The scheduler isn't owned
+	void SetScheduler(TaskScheduler* pScheduler) { m_pScheduler = pScheduler; }
+
+	//Agents that seek or arrive with nothing in view to avoid skip the steering pipeline, the kernels steer them all at once
+	//Off by default, the kernels only follow the way to the target the pipeline would take
+	void SetBatchSteering(bool batchSteering) { m_BatchSteering = batchSteering; }
+
+	//Keep the tree and steering of every agent together within a time budget each frame, see FrameBudgetScheduler
+	//The default budget ticks every agent every frame
+	void SetFrameBudget(const FrameBudgetSettings& settings) { m_FrameBudget.SetSettings(settings); }
+	const FrameBudgetScheduler& GetFrameBudget() const { return m_FrameBudget; }
+
+	//One frame for every agent, outputs holds the steering of each agent by index afterwards
+	void Update(float dt, vector<PluginOutput>& outputs);
+
+	size_t Size() const { return m_Agents.size(); }
+	ZombieAgent* GetAgent(size_t index) const { return m_Agents[index]; }
+	const AgentStateBuffers& GetState() const { return m_State; }
+	const WorldInfo& GetWorldInfo() const { return m_WorldInfo; }
+
+private:
+	//Agents per scheduler chunk, enough to keep stealing rare and each chunk on its own cache lines
+	static const size_t AgentsPerChunk = 16;
+
+	//Runs fn(index) for every agent, on the scheduler if there is one
+	template<typename Fn>
+	void ForEachAgent(const Fn& fn)
+	{
+		if (!m_pScheduler)
+		{
+			for (size_t i = 0; i < m_Agents.size(); ++i)
+				fn(i);
+			return;
+		}
+
+		m_pScheduler->ParallelFor(m_Agents.size(), AgentsPerChunk, [&fn](size_t begin, size_t end)
+		{
+			for (auto i = begin; i < end; ++i)
+				fn(i);
+		});
+	}
+
+	WorldInfo m_WorldInfo;
+	vector<ZombieAgent*> m_Agents;
+	AgentStateBuffers m_State;
+	SteeringBatch m_SteeringBatch;
+	FrameBudgetScheduler m_FrameBudget;
+	TaskScheduler* m_pScheduler = nullptr;
+	bool m_BatchSteering = false;
+};
+#pragma endregion
@@ -1,6 +1,8 @@
 #pragma once
 #include "stdafx.h"
 #include "Blackboard.h"
+#include "AgentBlackboard.h"
+#include "Logger.h"
 #include "BehaviorTree.h"
 #include "AI/SteeringBehaviours/SteeringBehaviours.h"
 
@@ -30,7 +32,32 @@ static const b2Vec2 WorldEdgeOffset = b2Vec2(25.f, 25.f);
  //x lower = y higher (less health = more important)
 inline float NormalizeLogarithmicInverse(const float val, const float e = 2)
 {
-	return pow(1 - val, e);
+	//Squaring is all we ever use, no need to go through pow for it
+	const float inverse = 1 - val;
+	if (e == 2)
+		return inverse * inverse;
+	return pow(inverse, e);
+}
+#pragma endregion
+
+#pragma region HELPERS
+//Everything the stats conditions look at, worked out whenever health or energy changed
+inline AgentVitals MeasureVitals(float health, float energy)
+{
+	AgentVitals vitals;
+	vitals.Health = static_cast<int>(health);
+	vitals.Energy = static_cast<int>(energy);
+	vitals.HealthCritical = NormalizeLogarithmicInverse(health / MaxHealth) >= 0.65;
+	vitals.EnergyCritical = NormalizeLogarithmicInverse(energy / MaxEnergy) >= 0.7;
+	vitals.HealthFull = health == MaxHealth;
+	vitals.EnergyFull = energy == MaxEnergy;
+	return vitals;
+}
+
+//House we're currently going for, nullptr if we don't have one
+inline const House* GetCurrentHouse(AgentBlackboard* pBoard)
+{
+	return pBoard->View(Keys::HouseLocations).Get(pBoard->View(Keys::CurrentHouse));
 }
 #pragma endregion
 
@@ -43,15 +70,11 @@ inline float NormalizeLogarithmicInverse(const float val, const float e = 2)
  //Core stats
 inline bool IsHealthCritical(Blackboard* pBlackboard)
 {
-	AgentInfo agentInfo;
-	auto valid = pBlackboard->GetData("AgentInfo", agentInfo);
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 
-	if (!valid) return false;
-
-	float hpNeed = NormalizeLogarithmicInverse(agentInfo.Health / MaxHealth);
-	if (hpNeed >= 0.65)
+	if (pBoard->View(Keys::Vitals).HealthCritical)
 	{
-		printf("Health critical\n");
+		LOG_VERBOSE(LogCategory::Stats, "Health critical.");
 		return true;
 	}
 
@@ -59,37 +82,21 @@ inline bool IsHealthCritical(Blackboard* pBlackboard)
 }
 inline bool IsEnergyCritical(Blackboard* pBlackboard)
 {
-	AgentInfo agentInfo;
-	auto valid = pBlackboard->GetData("AgentInfo", agentInfo);
-
-	if (!valid) return false;
-
-	float energyNeed = NormalizeLogarithmicInverse(agentInfo.Energy / MaxEnergy);
-	if (energyNeed >= 0.7)
-		return true;
-
-	return false;
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	return pBoard->View(Keys::Vitals).EnergyCritical;
 }
 
 //Eat whenever we're missing at least enough for not a single energy from food to go wasted
 //Clear inv as much as we can
 inline bool NotMaxHealth(Blackboard* pBlackboard)
 {
-	AgentInfo agentInfo;
-	auto valid = pBlackboard->GetData("AgentInfo", agentInfo);
-
-	if (!valid) return false;
-
-	return (agentInfo.Health != MaxHealth);
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	return !pBoard->View(Keys::Vitals).HealthFull;
 }
 inline bool NotMaxEnergy(Blackboard* pBlackboard)
 {
-	AgentInfo agentInfo;
-	auto valid = pBlackboard->GetData("AgentInfo", agentInfo);
-
-	if (!valid) return false;
-
-	return (agentInfo.Energy != MaxEnergy);
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	return !pBoard->View(Keys::Vitals).EnergyFull;
 }
 #pragma endregion
 
@@ -99,10 +106,11 @@ inline bool NotMaxEnergy(Blackboard* pBlackboard)
 //
 inline bool HasTargetItem(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	//If the current targetitem isnt taken, it means we .. well... havent taken it yet
 	//Grab it
 	TargetItem item;
-	auto valid = pBlackboard->GetData("TargetItem", item);
+	auto valid = pBoard->GetData(Keys::TargetItem, item);
 
 	if (!valid)
 		return false;
@@ -120,56 +128,59 @@ inline bool HasTargetItem(Blackboard* pBlackboard)
 //
 inline bool HasTargetHouse(Blackboard* pBlackboard)
 {
-	//Init data to null
-	House targetHouse;
-	auto dataAvailable = pBlackboard->GetData("CurrentHouse", targetHouse);
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	//Look up the house we're going for
+	const House* pTargetHouse = GetCurrentHouse(pBoard);
+	auto dataAvailable = pTargetHouse != nullptr;
 
 	//Check if valid
-	if (!dataAvailable || targetHouse.m_Checked)
+	if (!dataAvailable || pTargetHouse->m_Checked)
 		return false;
 
 	return true;
 }
 inline bool InsideTargetHouse(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	//Check if we're inside the house that we wanted to go into
-	House targetHouse;
+	const House* pTargetHouse = GetCurrentHouse(pBoard);
 	AgentInfo agentInfo;
-	auto dataAvailable = pBlackboard->GetData("CurrentHouse", targetHouse)
-		&& pBlackboard->GetData("AgentInfo", agentInfo);
+	auto dataAvailable = pTargetHouse != nullptr
+		&& pBoard->GetData(Keys::AgentInfo, agentInfo);
 
 	//Check if valid
-	if (!dataAvailable || targetHouse.m_Checked)
+	if (!dataAvailable || pTargetHouse->m_Checked)
 		return false;
 
 	//Check if inside the house
-	if (PointInRectangle(agentInfo.Position, targetHouse.m_HouseInfo.Center, targetHouse.m_HouseInfo.Size))
+	if (PointInRectangle(agentInfo.Position, pTargetHouse->m_HouseInfo.Center, pTargetHouse->m_HouseInfo.Size))
 		return true;
 
 	//Otherwise, we haven't reached the entrance yet so update our entrance position with the current position
-	pBlackboard->ChangeData("HouseEntrance", agentInfo.Position);
+	pBoard->ChangeData(Keys::HouseEntrance, agentInfo.Position);
 
 	return false;
 }
 //Search optimizing
 inline bool HouseBigEnough(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	//Is the house big enough to warrant corner checking
-	House currentHouse;
+	const House* pCurrentHouse = GetCurrentHouse(pBoard);
 	AgentInfo agentInfo;
-	auto dataAvailable = pBlackboard->GetData("CurrentHouse", currentHouse)
-		&& pBlackboard->GetData("AgentInfo", agentInfo);
+	auto dataAvailable = pCurrentHouse != nullptr
+		&& pBoard->GetData(Keys::AgentInfo, agentInfo);
 
 	if (!dataAvailable)
 		return false;
 
 	//Check size
-	if ((currentHouse.m_HouseInfo.Size.x / 2.f) >= agentInfo.FOV_Range)
+	if ((pCurrentHouse->m_HouseInfo.Size.x / 2.f) >= agentInfo.FOV_Range)
 		return false;
-	if ((currentHouse.m_HouseInfo.Size.y / 2.f) >= agentInfo.FOV_Range)
+	if ((pCurrentHouse->m_HouseInfo.Size.y / 2.f) >= agentInfo.FOV_Range)
 		return false;
 
-	printf("[House] Performing full house sweep.\n");
+	LOG_VERBOSE(LogCategory::House, "Performing full house sweep.");
 
 	return true;
 }
@@ -179,6 +190,23 @@ inline bool NoDiscoveryInTime(Blackboard* pBlackboard)
 	return true;
 }
 #pragma endregion
+
+#pragma region Inputs
+//Entries every condition reads, a memoized condition is only evaluated again when one of them changed
+//0 for conditions that change the blackboard or read something that changes every frame, those are always evaluated
+namespace ConditionInputs
+{
+	static constexpr BlackboardSlotMask IsHealthCritical = SlotMask(Keys::Vitals);
+	static constexpr BlackboardSlotMask IsEnergyCritical = SlotMask(Keys::Vitals);
+	static constexpr BlackboardSlotMask NotMaxHealth = SlotMask(Keys::Vitals);
+	static constexpr BlackboardSlotMask NotMaxEnergy = SlotMask(Keys::Vitals);
+	static constexpr BlackboardSlotMask HasTargetItem = SlotMask(Keys::TargetItem);
+	static constexpr BlackboardSlotMask HasTargetHouse = SlotMask(Keys::CurrentHouse, Keys::HouseLocations);
+	static constexpr BlackboardSlotMask InsideTargetHouse = 0;
+	static constexpr BlackboardSlotMask HouseBigEnough = 0;
+	static constexpr BlackboardSlotMask NoDiscoveryInTime = 0;
+}
+#pragma endregion
 #pragma endregion
 
 #pragma region ACTIONS
@@ -192,97 +220,65 @@ inline bool NoDiscoveryInTime(Blackboard* pBlackboard)
  //
 inline BehaviorState UseAnyHealthKit(Blackboard* pBlackboard)
 {
-	ExamPlugin* plugin;
-	bool valid = pBlackboard->GetData("Plugin", plugin);
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	IAgentHost* pHost;
+	bool valid = pBoard->GetData(Keys::Host, pHost);
 
 	if (!valid)
 		return Failure;
 
-	//Find the food in our inventory
-	for (auto i = 0; i < plugin->INVENTORY_GetCapacity(); ++i)
-	{
-		ItemInfo item;
-		if (plugin->INVENTORY_GetItem(i, item))
-		{
-			if (item.Type == HEALTH)
-			{
-				plugin->INVENTORY_UseItem(i);
-				plugin->INVENTORY_RemoveItem(i);
-				printf("[Item] Used an emergency healthpack.\n");
-				return Success;
-			}
-		}
-	}
+	//Find the healthpack in our inventory
+	const auto slot = pBoard->View(Keys::Inventory).FirstOf(HEALTH);
+	if (slot == -1)
+		return Failure;
 
-	return Failure;
+	auto inventory = pBoard->Borrow(Keys::Inventory);
+	inventory->Use(pHost, slot);
+	inventory->Remove(pHost, slot);
+	LOG_INFO(LogCategory::Item, "Used an emergency healthpack.");
+	return Success;
 }
 inline BehaviorState UseAnyFood(Blackboard* pBlackboard)
 {
-	ExamPlugin* plugin;
-	bool valid = pBlackboard->GetData("Plugin", plugin);
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	IAgentHost* pHost;
+	bool valid = pBoard->GetData(Keys::Host, pHost);
 
 	if (!valid)
 		return Failure;
 
 	//Find the food in our inventory
-	for (auto i = 0; i < plugin->INVENTORY_GetCapacity(); ++i)
-	{
-		ItemInfo item;
-		if (plugin->INVENTORY_GetItem(i, item))
-		{
-			if (item.Type == FOOD)
-			{
-				plugin->INVENTORY_UseItem(i);
-				plugin->INVENTORY_RemoveItem(i);
-				printf("[Item] Ate some emergency food.\n");
-				return Success;
-			}
-		}
-	}
+	const auto slot = pBoard->View(Keys::Inventory).FirstOf(FOOD);
+	if (slot == -1)
+		return Failure;
 
-	return Failure;
+	auto inventory = pBoard->Borrow(Keys::Inventory);
+	inventory->Use(pHost, slot);
+	inventory->Remove(pHost, slot);
+	LOG_INFO(LogCategory::Item, "Ate some emergency food.");
+	return Success;
 }
 inline BehaviorState UseBestHealthKit(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	AgentInfo agentInfo;
-	ExamPlugin* plugin;
-	bool valid = pBlackboard->GetData("Plugin", plugin)
-		&& pBlackboard->GetData("AgentInfo", agentInfo);
+	IAgentHost* pHost;
+	bool valid = pBoard->GetData(Keys::Host, pHost)
+		&& pBoard->GetData(Keys::AgentInfo, agentInfo);
 
 	if (!valid)
 		return Failure;
 
 	//Find the healthpack in our inventory
 	//Use the one that gets us closest to the max hp but not over
-	int bestSlot = -1;
-	int bestAmount = -10;
-
-	for (auto i = 0; i < plugin->INVENTORY_GetCapacity(); ++i)
-	{
-		ItemInfo item;
-		if (plugin->INVENTORY_GetItem(i, item))
-		{
-			if (item.Type == HEALTH)
-			{
-				int amount = 0;
-				if (plugin->ITEM_GetMetadata(item, "health", amount))
-				{
-					int left = (MaxHealth - agentInfo.Health - amount);
-					if (left >= bestAmount && left >= 0)
-					{
-						bestSlot = i;
-						bestAmount = left;
-					}
-				}
-			}
-		}
-	}
+	const auto bestSlot = pBoard->View(Keys::Inventory).BestFit(HEALTH, MaxHealth - agentInfo.Health);
 
 	if (bestSlot != -1)
 	{
-		plugin->INVENTORY_UseItem(bestSlot);
-		plugin->INVENTORY_RemoveItem(bestSlot);
-		printf("[Item] Used a healthkit.\n");
+		auto inventory = pBoard->Borrow(Keys::Inventory);
+		inventory->Use(pHost, bestSlot);
+		inventory->Remove(pHost, bestSlot);
+		LOG_INFO(LogCategory::Item, "Used a healthkit.");
 		return Success;
 	}
 
@@ -290,45 +286,25 @@ inline BehaviorState UseBestHealthKit(Blackboard* pBlackboard)
 }
 inline BehaviorState UseBestFood(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	AgentInfo agentInfo;
-	ExamPlugin* plugin;
-	bool valid = pBlackboard->GetData("Plugin", plugin)
-		&& pBlackboard->GetData("AgentInfo", agentInfo);
+	IAgentHost* pHost;
+	bool valid = pBoard->GetData(Keys::Host, pHost)
+		&& pBoard->GetData(Keys::AgentInfo, agentInfo);
 
 	if (!valid)
 		return Failure;
 
 	//Find the food in our inventory
 	//Use the one that gets us closest to the max hp but not over
-	int bestSlot = -1;
-	int bestAmount = -20;
-
-	for (auto i = 0; i < plugin->INVENTORY_GetCapacity(); ++i)
-	{
-		ItemInfo item;
-		if (plugin->INVENTORY_GetItem(i, item))
-		{
-			if (item.Type == FOOD)
-			{
-				int amount = 0;
-				if (plugin->ITEM_GetMetadata(item, "energy", amount))
-				{
-					int left = (MaxEnergy - agentInfo.Energy - amount);
-					if (left >= bestAmount && left >= 0)
-					{
-						bestSlot = i;
-						bestAmount = left;
-					}
-				}
-			}
-		}
-	}
+	const auto bestSlot = pBoard->View(Keys::Inventory).BestFit(FOOD, MaxEnergy - agentInfo.Energy);
 
 	if (bestSlot != -1)
 	{
-		plugin->INVENTORY_UseItem(bestSlot);
-		plugin->INVENTORY_RemoveItem(bestSlot);
-		printf("[Item] Ate some food.\n");
+		auto inventory = pBoard->Borrow(Keys::Inventory);
+		inventory->Use(pHost, bestSlot);
+		inventory->Remove(pHost, bestSlot);
+		LOG_INFO(LogCategory::Item, "Ate some food.");
 		return Success;
 	}
 
@@ -342,50 +318,48 @@ inline BehaviorState UseBestFood(Blackboard* pBlackboard)
 //
 inline BehaviorState SpotNewItem(Blackboard* pBlackboard)
 {
-	vector<EntityInfo> items;
-	auto valid = pBlackboard->GetData("Items", items);
-
-	if (!valid)
-		return Failure;
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	const auto& items = pBoard->View(Keys::Items);
 
-	int vecSize = items.size();
-	if (vecSize <= 0)
+	if (items.Empty())
 		return Failure;
 
 	//Get the last item
 	TargetItem targetItem;
-	targetItem.m_EntityInfo = items[vecSize - 1];
+	targetItem.m_EntityInfo = items.Newest();
 	targetItem.m_Valid = true;
 
 	//Change targetitem
-	pBlackboard->ChangeData("TargetItem", targetItem);
+	pBoard->ChangeData(Keys::TargetItem, targetItem);
 
-	printf("[Item] Moving to pick up a new item.\n");
+	LOG_INFO(LogCategory::Item, "Moving to pick up a new item.");
 	return Success;
 }
 inline BehaviorState SetItemAsTarget(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	b2Vec2 target;
 	TargetItem item;
 
-	auto valid = pBlackboard->GetData("TargetItem", item);
+	auto valid = pBoard->GetData(Keys::TargetItem, item);
 
 	if (!valid || item.m_Taken)
 		return Failure;
 
-	printf("[Item] Moving to item\n");
+	LOG_VERBOSE(LogCategory::Item, "Moving to item.");
 
 	target = item.m_EntityInfo.Position;
-	pBlackboard->ChangeData("Target", target);
+	pBoard->ChangeData(Keys::Target, target);
 
 	return Success;
 }
 inline BehaviorState PickupItem(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	TargetItem item;
 	AgentInfo agentInfo;
-	auto valid = pBlackboard->GetData("TargetItem", item)
-		&& pBlackboard->GetData("AgentInfo", agentInfo);
+	auto valid = pBoard->GetData(Keys::TargetItem, item)
+		&& pBoard->GetData(Keys::AgentInfo, agentInfo);
 
 	if (!valid || item.m_Taken || !item.m_Valid)
 		return Failure;
@@ -393,53 +367,42 @@ inline BehaviorState PickupItem(Blackboard* pBlackboard)
 	//Move to pick up the item
 	if (abs(agentInfo.Position - item.m_EntityInfo.Position).LengthSquared() < agentInfo.GrabRange * agentInfo.GrabRange)
 	{
-		ExamPlugin* plugin;
-		pBlackboard->GetData("Plugin", plugin);
+		IAgentHost* pHost;
+		pBoard->GetData(Keys::Host, pHost);
 
 		//Grab the item info
 		ItemInfo itemInfo;
-		bool validItem = plugin->ITEM_Grab(item.m_EntityInfo, itemInfo);
+		bool validItem = pHost->ITEM_Grab(item.m_EntityInfo, itemInfo);
 
 		if (validItem)
 		{
 			bool pickedUp = false;
-
-			int freeSlot = -1;
-			ItemInfo slotItem;
+			auto inventory = pBoard->Borrow(Keys::Inventory);
+			const auto capacity = inventory->Capacity();
 
 #pragma region EmptySlotCheck
 			//If we have an empty slot, put it in there
+			//Replace garbage and guns in our inventory, we dont care for those
 			//Save last spot for discarding useless item to force them to respawn (and potentially become useful)
-			for (int slot = 0; slot < plugin->INVENTORY_GetCapacity() - 1; ++slot)
+			const auto usableSlots = inventory->FreeSlots() | inventory->SlotsOf(GARBAGE) | inventory->SlotsOf(PISTOL);
+			const auto freeSlot = InventoryIndex::LowestSlot(usableSlots & InventoryIndex::SlotsBelow(capacity - 1));
+
+			if (inventory->IsUsed(freeSlot))
 			{
-				if (!plugin->INVENTORY_GetItem(slot, slotItem))
-				{
-					freeSlot = slot;
-					break;
-				}
-				else
-				{
-					//Replace garbage and guns in our inventory, we dont care for those
-					if (slotItem.Type == GARBAGE || slotItem.Type == PISTOL)
-					{
-						printf("[Item] Replacing useless item in inventory with something else.\n");
-						plugin->INVENTORY_RemoveItem(slot);
-						freeSlot = slot;
-						break;
-					}
-				}
+				LOG_INFO(LogCategory::Item, "Replacing useless item in inventory with something else.");
+				inventory->Remove(pHost, freeSlot);
 			}
 #pragma endregion
 
 			//If there was a free slot, put the new item in there
 			if (freeSlot != -1)
 			{
-				if (plugin->INVENTORY_AddItem(freeSlot, itemInfo))
+				if (inventory->Add(pHost, freeSlot, itemInfo))
 					pickedUp = true;
 				if (itemInfo.Type == GARBAGE || itemInfo.Type == PISTOL)
 				{
-					plugin->INVENTORY_RemoveItem(freeSlot);
-					printf("[Item] New item was useless, removed it.\n");
+					inventory->Remove(pHost, freeSlot);
+					LOG_INFO(LogCategory::Item, "New item was useless, removed it.");
 				}
 			}
 			//Otherwise, start weighing what item will be more useful
@@ -454,12 +417,12 @@ inline BehaviorState PickupItem(Blackboard* pBlackboard)
 				switch (itemInfo.Type)
 				{
 				case PISTOL:
-					plugin->INVENTORY_AddItem(plugin->INVENTORY_GetCapacity(), itemInfo);
-					plugin->INVENTORY_RemoveItem(plugin->INVENTORY_GetCapacity());
-					printf("[Item] Found a pistol and discarded it.\n");
+					inventory->Add(pHost, capacity, itemInfo);
+					inventory->Remove(pHost, capacity);
+					LOG_INFO(LogCategory::Item, "Found a pistol and discarded it.");
 					break;
 				case FOOD:
-					printf("[Item] Found food.\n");
+					LOG_INFO(LogCategory::Item, "Found food.");
 					if (UseAnyFood(pBlackboard) == Success)
 					{
 						PickupItem(pBlackboard);
@@ -472,29 +435,29 @@ inline BehaviorState PickupItem(Blackboard* pBlackboard)
 						}
 						else
 						{
-							plugin->INVENTORY_AddItem(plugin->INVENTORY_GetCapacity(), itemInfo);
-							plugin->INVENTORY_RemoveItem(plugin->INVENTORY_GetCapacity());
-							printf("[Item] Discarded excess food.\n");
+							inventory->Add(pHost, capacity, itemInfo);
+							inventory->Remove(pHost, capacity);
+							LOG_INFO(LogCategory::Item, "Discarded excess food.");
 						}
 					}
 					break;
 				case HEALTH:
-					printf("[Item] Found health.\n");
+					LOG_INFO(LogCategory::Item, "Found health.");
 					if (UseAnyHealthKit(pBlackboard) == Success)
 					{
 						PickupItem(pBlackboard);
 					}
 					else
 					{
-						plugin->INVENTORY_AddItem(plugin->INVENTORY_GetCapacity(), itemInfo);
-						plugin->INVENTORY_RemoveItem(plugin->INVENTORY_GetCapacity());
-						printf("[Item] Discarded excess healthkit.\n");
+						inventory->Add(pHost, capacity, itemInfo);
+						inventory->Remove(pHost, capacity);
+						LOG_INFO(LogCategory::Item, "Discarded excess healthkit.");
 					}
 					break;
 				case GARBAGE:
-					plugin->INVENTORY_AddItem(plugin->INVENTORY_GetCapacity(), itemInfo);
-					plugin->INVENTORY_RemoveItem(plugin->INVENTORY_GetCapacity());
-					printf("[Item] Found junk and discarded it.\n");
+					inventory->Add(pHost, capacity, itemInfo);
+					inventory->Remove(pHost, capacity);
+					LOG_INFO(LogCategory::Item, "Found junk and discarded it.");
 					break;
 				default:
 					break;
@@ -503,47 +466,34 @@ inline BehaviorState PickupItem(Blackboard* pBlackboard)
 
 			//Set the current TargetItem to picked up if we did
 			item.m_Taken = pickedUp;
-			pBlackboard->ChangeData("TargetItem", item);
+			pBoard->ChangeData(Keys::TargetItem, item);
 
 			//Remove it from our backlog of items to go for
 			if (pickedUp)
 			{
-				vector<EntityInfo> itemsLog;
-				if (pBlackboard->GetData("Items", itemsLog))
+				auto itemsLog = pBoard->Borrow(Keys::Items);
+				if (itemsLog->Remove(item.m_EntityInfo.Position))
+				{
+					LOG_INFO(LogCategory::Item, "Cleared item from backlog.");
+				}
+				else
 				{
-					for (auto it = itemsLog.begin(); it != itemsLog.end(); ++it)
-					{
-						if (it->Position == item.m_EntityInfo.Position)
-						{
-							printf("[Item] Cleared item from backlog.\n");
-							itemsLog.erase(itemsLog.end() - 1);
-							pBlackboard->ChangeData("Items", itemsLog);
-							break;
-						}
-					}
-
 					//Couldn't find it, something broke, reset the itemslog to prevent getting stuck
-					itemsLog.clear();
-					pBlackboard->ChangeData("Items", itemsLog);
+					itemsLog->Clear();
 				}
 			}
 
-			printf("[Item] Picked up an item.\n");
+			LOG_INFO(LogCategory::Item, "Picked up an item.");
 			return Success;
 		}
 
 		//It failed, so its an FOV problem
 		//Ignore the item for now to avoid getting stuck
 		item.m_Taken = true;
-		pBlackboard->ChangeData("TargetItem", item);
+		pBoard->ChangeData(Keys::TargetItem, item);
 
-		vector<EntityInfo> itemsLog;
-		if (pBlackboard->GetData("Items", itemsLog))
-		{
-			printf("[Item] Cleared item from backlog to avoid getting stuck.\n");
-			if (itemsLog.size() > 0) itemsLog.erase(itemsLog.end() - 1);
-			pBlackboard->ChangeData("Items", itemsLog);
-		}
+		if (pBoard->Borrow(Keys::Items)->Remove(item.m_EntityInfo.Position))
+			LOG_WARNING(LogCategory::Item, "Cleared item from backlog to avoid getting stuck.");
 
 		return Failure;
 	}
@@ -551,7 +501,7 @@ inline BehaviorState PickupItem(Blackboard* pBlackboard)
 	{
 		//Set target to go to the item
 		b2Vec2 target = item.m_EntityInfo.Position;
-		pBlackboard->ChangeData("Target", target);
+		pBoard->ChangeData(Keys::Target, target);
 	}
 
 	return Running;
@@ -564,213 +514,183 @@ inline BehaviorState PickupItem(Blackboard* pBlackboard)
 //
 inline BehaviorState SetTargetHouse(Blackboard* pBlackboard)
 {
-	House targetHouse;
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 
-	//Get a new target house
-	vector<House> houseLocations;
-	auto dataAvailable = pBlackboard->GetData("HouseLocations", houseLocations);
+	//Get a new target house, the most recently discovered one we haven't checked
+	auto targetHouse = pBoard->View(Keys::HouseLocations).NextUnchecked();
 
-	if (!dataAvailable)
+	if (!targetHouse.IsValid())
 		return Failure;
 
-	int vecSize = houseLocations.size();
-	if (vecSize <= 0)
-		return Failure;
-
-	//Check houses
-	for (int i = vecSize - 1; i >= 0; --i)
-	{
-		if (!houseLocations[i].m_Checked)
-		{
-			pBlackboard->ChangeData("CurrentHouse", houseLocations[i]);
-			return Success;
-		}
-	}
-
-	return Failure;
+	pBoard->ChangeData(Keys::CurrentHouse, targetHouse);
+	return Success;
 }
 inline BehaviorState SetHouseAsTarget(Blackboard* pBlackboard)
 {
-	//Init data to null
-	House targetHouse;
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 
 	//Get the required data
-	auto dataAvailable = pBlackboard->GetData("CurrentHouse", targetHouse);
+	const House* pTargetHouse = GetCurrentHouse(pBoard);
+	auto dataAvailable = pTargetHouse != nullptr;
 
 	if (!dataAvailable)
 		return Failure;
-	if (targetHouse.m_Checked)
+	if (pTargetHouse->m_Checked)
 		return Failure;
 
 	//Set the house center as the new target
-	pBlackboard->ChangeData("Target", targetHouse.m_HouseInfo.Center);
+	pBoard->ChangeData(Keys::Target, pTargetHouse->m_HouseInfo.Center);
 	return Success;
 }
 //Searching for items
 inline BehaviorState CheckHouseCenter(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	const House* pCurrentHouse = GetCurrentHouse(pBoard);
 	AgentInfo agentInfo;
-	House currentHouse;
-	auto dataAvailable = pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("CurrentHouse", currentHouse);
+	auto dataAvailable = pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pCurrentHouse != nullptr;
 
 	if (!dataAvailable)
 		return Failure;
 
 	//If the agent is near the center, success!
-	if (abs(currentHouse.m_HouseInfo.Center - agentInfo.Position).LengthSquared() <= 0.1f)
+	if (abs(pCurrentHouse->m_HouseInfo.Center - agentInfo.Position).LengthSquared() <= 0.1f)
 	{
-		printf("[HOUSE] Center checked.\n");
+		LOG_INFO(LogCategory::House, "Center checked.");
 		return Success;
 	}
 
 	//Else set the target
-	pBlackboard->ChangeData("Target", currentHouse.m_HouseInfo.Center);
+	pBoard->ChangeData(Keys::Target, pCurrentHouse->m_HouseInfo.Center);
 	return Running;
 }
 inline BehaviorState CheckTopLeftCorner(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	const House* pCurrentHouse = GetCurrentHouse(pBoard);
 	AgentInfo agentInfo;
-	House currentHouse;
-	auto dataAvailable = pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("CurrentHouse", currentHouse);
+	auto dataAvailable = pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pCurrentHouse != nullptr;
 
 	if (!dataAvailable)
 		return Failure;
 
-	auto wallDistance = currentHouse.m_HouseInfo.Size / 2.f;
-	auto corner = currentHouse.m_HouseInfo.Center - b2Vec2(wallDistance.x, -wallDistance.y) + b2Vec2(HouseWallOffset.x, -HouseWallOffset.y);
+	auto wallDistance = pCurrentHouse->m_HouseInfo.Size / 2.f;
+	auto corner = pCurrentHouse->m_HouseInfo.Center - b2Vec2(wallDistance.x, -wallDistance.y) + b2Vec2(HouseWallOffset.x, -HouseWallOffset.y);
 
 	//If the agent is near the topleft corner, success!
 	if (abs(corner - agentInfo.Position).LengthSquared() <= agentInfo.FOV_Range * agentInfo.FOV_Range)
 	{
-		printf("[HOUSE] Top-left corner checked.\n");
+		LOG_INFO(LogCategory::House, "Top-left corner checked.");
 		return Success;
 	}
 
 	//Else set the target
-	pBlackboard->ChangeData("Target", corner);
+	pBoard->ChangeData(Keys::Target, corner);
 
 	return Running;
 }
 inline BehaviorState CheckTopRightCorner(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	const House* pCurrentHouse = GetCurrentHouse(pBoard);
 	AgentInfo agentInfo;
-	House currentHouse;
-	auto dataAvailable = pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("CurrentHouse", currentHouse);
+	auto dataAvailable = pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pCurrentHouse != nullptr;
 
 	if (!dataAvailable)
 		return Failure;
 
-	auto wallDistance = currentHouse.m_HouseInfo.Size / 2.f;
-	auto corner = currentHouse.m_HouseInfo.Center + b2Vec2(wallDistance.x, wallDistance.y) - HouseWallOffset;
+	auto wallDistance = pCurrentHouse->m_HouseInfo.Size / 2.f;
+	auto corner = pCurrentHouse->m_HouseInfo.Center + b2Vec2(wallDistance.x, wallDistance.y) - HouseWallOffset;
 
 	//If the agent is near the topleft corner, success!
 	if (abs(corner - agentInfo.Position).LengthSquared() <= agentInfo.FOV_Range * agentInfo.FOV_Range)
 	{
-		printf("[HOUSE] Top-right corner checked.\n");
+		LOG_INFO(LogCategory::House, "Top-right corner checked.");
 		return Success;
 	}
 
 	//Else set the target
-	pBlackboard->ChangeData("Target", corner);
+	pBoard->ChangeData(Keys::Target, corner);
 	return Running;
 }
 inline BehaviorState CheckBottomRightCorner(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	const House* pCurrentHouse = GetCurrentHouse(pBoard);
 	AgentInfo agentInfo;
-	House currentHouse;
-	auto dataAvailable = pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("CurrentHouse", currentHouse);
+	auto dataAvailable = pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pCurrentHouse != nullptr;
 
 	if (!dataAvailable)
 		return Failure;
 
-	auto wallDistance = currentHouse.m_HouseInfo.Size / 2.f;
-	auto corner = currentHouse.m_HouseInfo.Center + b2Vec2(wallDistance.x, -wallDistance.y) + b2Vec2(-HouseWallOffset.x, HouseWallOffset.y);
+	auto wallDistance = pCurrentHouse->m_HouseInfo.Size / 2.f;
+	auto corner = pCurrentHouse->m_HouseInfo.Center + b2Vec2(wallDistance.x, -wallDistance.y) + b2Vec2(-HouseWallOffset.x, HouseWallOffset.y);
 
 	//If the agent is near the topleft corner, success!
 	if (abs(corner - agentInfo.Position).LengthSquared() <= agentInfo.FOV_Range * agentInfo.FOV_Range)
 	{
-		printf("[HOUSE] Bottom-right corner checked.\n");
+		LOG_INFO(LogCategory::House, "Bottom-right corner checked.");
 		return Success;
 	}
 
 	//Else set the target
-	pBlackboard->ChangeData("Target", corner);
+	pBoard->ChangeData(Keys::Target, corner);
 	return Running;
 }
 inline BehaviorState CheckBottomLeftCorner(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	const House* pCurrentHouse = GetCurrentHouse(pBoard);
 	AgentInfo agentInfo;
-	House currentHouse;
-	auto dataAvailable = pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("CurrentHouse", currentHouse);
+	auto dataAvailable = pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pCurrentHouse != nullptr;
 
 	if (!dataAvailable)
 		return Failure;
 
-	auto wallDistance = currentHouse.m_HouseInfo.Size / 2.f;
-	auto corner = currentHouse.m_HouseInfo.Center - b2Vec2(wallDistance.x, wallDistance.y) + HouseWallOffset;
+	auto wallDistance = pCurrentHouse->m_HouseInfo.Size / 2.f;
+	auto corner = pCurrentHouse->m_HouseInfo.Center - b2Vec2(wallDistance.x, wallDistance.y) + HouseWallOffset;
 
 	//If the agent is near the topleft corner, success!
 	if (abs(corner - agentInfo.Position).LengthSquared() <= agentInfo.FOV_Range * agentInfo.FOV_Range)
 	{
-		printf("[HOUSE] Bottom-left corner checked.\n");
+		LOG_INFO(LogCategory::House, "Bottom-left corner checked.");
 		return Success;
 	}
 
 	//Else set the target
-	pBlackboard->ChangeData("Target", corner);
+	pBoard->ChangeData(Keys::Target, corner);
 	return Running;
 }
 //Done checking
 inline BehaviorState MarkHouseChecked(Blackboard* pBlackboard)
 {
-	//Init data to null
-	House targetHouse;
-	//Get the required data
-	auto dataAvailable = pBlackboard->GetData("CurrentHouse", targetHouse);
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 
-	if (dataAvailable && !targetHouse.m_Checked)
+	//The handle points straight at the house in our registry, no need to look for it
+	const auto& targetHouse = pBoard->View(Keys::CurrentHouse);
+	if (pBoard->Borrow(Keys::HouseLocations)->MarkChecked(targetHouse))
 	{
-		targetHouse.m_Checked = true;
-		vector<House> houseLocations;
-		auto dataAvailable = pBlackboard->GetData("HouseLocations", houseLocations);
-
-		if (dataAvailable)
-		{
-			size_t index = 0;
-
-			//Find this house in our vector of houses
-			for (auto it = houseLocations.begin(); it != houseLocations.end(); ++it)
-			{
-				if (targetHouse.m_HouseInfo.Center == it->m_HouseInfo.Center)
-				{
-					houseLocations[index].m_Checked = true;
-					printf("[HOUSE] Current house marked as checked.\n");
-					pBlackboard->ChangeData("CurrentHouse", targetHouse);
-					pBlackboard->ChangeData("HouseLocations", houseLocations);
-					return Success;
-				}
-
-				++index;
-			}
-		}
+		LOG_INFO(LogCategory::House, "Current house marked as checked.");
+		return Success;
 	}
 
 	return Failure;
 }
 inline BehaviorState LeaveHouse(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	//Leave the house back the way we came in
+	const House* pCurrentHouse = GetCurrentHouse(pBoard);
 	AgentInfo agentInfo;
 	b2Vec2 entryPoint;
-	House currentHouse;
-	auto dataAvailable = pBlackboard->GetData("HouseEntrance", entryPoint)
-		&& pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("CurrentHouse", currentHouse);
+	auto dataAvailable = pBoard->GetData(Keys::HouseEntrance, entryPoint)
+		&& pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pCurrentHouse != nullptr;
 
 	if (!dataAvailable)
 		return Failure;
@@ -778,29 +698,29 @@ inline BehaviorState LeaveHouse(Blackboard* pBlackboard)
 	b2Vec2 offset = b2Vec2_zero;
 
 	//Is the entrance on the left or on the right?
-	if (entryPoint.x > currentHouse.m_HouseInfo.Center.x)
+	if (entryPoint.x > pCurrentHouse->m_HouseInfo.Center.x)
 		offset.x = 15;
 	else
 		offset.x = -15;
 
 	//Is the entrance above or below
-	if (entryPoint.y > currentHouse.m_HouseInfo.Center.y)
+	if (entryPoint.y > pCurrentHouse->m_HouseInfo.Center.y)
 		offset.y = 15;
 	else
 		offset.y = -15;
 
 	//If the agent is near the exit
 	//Alternatively, if the actor is sufficiently out of the house
-	if (abs((entryPoint + offset) - agentInfo.Position).LengthSquared() <= 5.f || abs(currentHouse.m_HouseInfo.Center - agentInfo.Position).LengthSquared() > ((currentHouse.m_HouseInfo.Size - currentHouse.m_HouseInfo.Center).LengthSquared() + 500.f))
+	if (abs((entryPoint + offset) - agentInfo.Position).LengthSquared() <= 5.f || abs(pCurrentHouse->m_HouseInfo.Center - agentInfo.Position).LengthSquared() > ((pCurrentHouse->m_HouseInfo.Size - pCurrentHouse->m_HouseInfo.Center).LengthSquared() + 500.f))
 	{
-		printf("[HOUSE] Exited house.\n");
+		LOG_INFO(LogCategory::House, "Exited house.");
 		return Success;
 	}
 
-	printf("Leaving house\n");
+	LOG_VERBOSE(LogCategory::House, "Leaving house.");
 
 	//Set the target to the outside area
-	pBlackboard->ChangeData("Target", entryPoint + offset);
+	pBoard->ChangeData(Keys::Target, entryPoint + offset);
 	return Running;
 }
 #pragma endregion
@@ -808,129 +728,145 @@ inline BehaviorState LeaveHouse(Blackboard* pBlackboard)
 #pragma region MapWandering
 inline BehaviorState CheckWorldTopLeft(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	AgentInfo agentInfo;
-	WorldInfo worldInfo;
-	auto dataAvailable = pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("WorldInfo", worldInfo);
+	const WorldInfo* pWorldInfo = nullptr;
+	auto dataAvailable = pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pBoard->GetData(Keys::WorldInfo, pWorldInfo);
 
-	if (!dataAvailable)
+	if (!dataAvailable || !pWorldInfo)
 		return Failure;
 
+	const auto& worldInfo = *pWorldInfo;
+
 	auto corner = worldInfo.Center + b2Vec2(-worldInfo.Dimensions.x / 2.f, worldInfo.Dimensions.y / 2.f) + b2Vec2(WorldEdgeOffset.x, -WorldEdgeOffset.y);
 
 	//If the agent is near the topleft corner, success!
 	if (abs(corner - agentInfo.Position).LengthSquared() <= 10.f)
 	{
-		printf("[WORLD] Topleft checked.\n");
+		LOG_INFO(LogCategory::World, "Topleft checked.");
 		return Success;
 	}
 
-	printf("Checking world\n");
+	LOG_VERBOSE(LogCategory::World, "Checking world.");
 
 	//Else set the target
-	pBlackboard->ChangeData("Target", corner);
+	pBoard->ChangeData(Keys::Target, corner);
 	return Running;
 }
 inline BehaviorState CheckWorldTopRight(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	AgentInfo agentInfo;
-	WorldInfo worldInfo;
-	auto dataAvailable = pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("WorldInfo", worldInfo);
+	const WorldInfo* pWorldInfo = nullptr;
+	auto dataAvailable = pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pBoard->GetData(Keys::WorldInfo, pWorldInfo);
 
-	if (!dataAvailable)
+	if (!dataAvailable || !pWorldInfo)
 		return Failure;
 
+	const auto& worldInfo = *pWorldInfo;
+
 	auto corner = worldInfo.Center + b2Vec2(worldInfo.Dimensions.x / 2.f, worldInfo.Dimensions.y / 2.f) + b2Vec2(-WorldEdgeOffset.x, -WorldEdgeOffset.y);
 
 	//If the agent is near the topright corner, success!
 	if (abs(corner - agentInfo.Position).LengthSquared() <= 10.f)
 	{
-		printf("[WORLD] Toprightchecked.\n");
+		LOG_INFO(LogCategory::World, "Topright checked.");
 		return Success;
 	}
 
 	//Else set the target
-	pBlackboard->ChangeData("Target", corner);
+	pBoard->ChangeData(Keys::Target, corner);
 	return Running;
 }
 inline BehaviorState CheckWorldBottomRight(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	AgentInfo agentInfo;
-	WorldInfo worldInfo;
-	auto dataAvailable = pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("WorldInfo", worldInfo);
+	const WorldInfo* pWorldInfo = nullptr;
+	auto dataAvailable = pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pBoard->GetData(Keys::WorldInfo, pWorldInfo);
 
-	if (!dataAvailable)
+	if (!dataAvailable || !pWorldInfo)
 		return Failure;
 
+	const auto& worldInfo = *pWorldInfo;
+
 	auto corner = worldInfo.Center + b2Vec2(worldInfo.Dimensions.x / 2.f, -worldInfo.Dimensions.y / 2.f) + b2Vec2(-WorldEdgeOffset.x, WorldEdgeOffset.y);
 
 	//If the agent is near the bottomright corner, success!
 	if (abs(corner - agentInfo.Position).LengthSquared() <= 10.f)
 	{
-		printf("[WORLD] Bottomright checked.\n");
+		LOG_INFO(LogCategory::World, "Bottomright checked.");
 		return Success;
 	}
 
 	//Else set the target
-	pBlackboard->ChangeData("Target", corner);
+	pBoard->ChangeData(Keys::Target, corner);
 	return Running;
 }
 inline BehaviorState CheckWorldBottomLeft(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	AgentInfo agentInfo;
-	WorldInfo worldInfo;
-	auto dataAvailable = pBlackboard->GetData("AgentInfo", agentInfo)
-		&& pBlackboard->GetData("WorldInfo", worldInfo);
+	const WorldInfo* pWorldInfo = nullptr;
+	auto dataAvailable = pBoard->GetData(Keys::AgentInfo, agentInfo)
+		&& pBoard->GetData(Keys::WorldInfo, pWorldInfo);
 
-	if (!dataAvailable)
+	if (!dataAvailable || !pWorldInfo)
 		return Failure;
 
+	const auto& worldInfo = *pWorldInfo;
+
 	auto corner = worldInfo.Center - b2Vec2(worldInfo.Dimensions.x / 2.f, worldInfo.Dimensions.y / 2.f) + b2Vec2(WorldEdgeOffset.x, WorldEdgeOffset.y);
 
 	//If the agent is near the bottomleft corner, success!
 	if (abs(corner - agentInfo.Position).LengthSquared() <= 10.f)
 	{
-		printf("[WORLD] Bottomleft checked.\n");
+		LOG_INFO(LogCategory::World, "Bottomleft checked.");
 		return Success;
 	}
 
 	//Else set the target
-	pBlackboard->ChangeData("Target", corner);
+	pBoard->ChangeData(Keys::Target, corner);
 	return Running;
 }
 inline BehaviorState ResetHouses(Blackboard* pBlackboard)
 {
-	pBlackboard->ChangeData("HouseLocations", vector<House>{});
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	//Clear in place so the storage is kept for the next round
+	pBoard->Borrow(Keys::HouseLocations)->Clear();
 	return Success;
 }
 #pragma endregion
 
 #pragma region Sprinting
-BehaviorState StartSprinting(Blackboard* pBlackboard)
+inline BehaviorState StartSprinting(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	AgentInfo agentInfo;
-	auto valid = pBlackboard->GetData("AgentInfo", agentInfo);
+	auto valid = pBoard->GetData(Keys::AgentInfo, agentInfo);
 
 	if (!valid)
 		return Failure;
 
 	agentInfo.RunMode = true;
-	pBlackboard->ChangeData("AgentInfo", agentInfo);
+	pBoard->ChangeData(Keys::AgentInfo, agentInfo);
 
 	return Success;
 }
-BehaviorState StopSprinting(Blackboard* pBlackboard)
+inline BehaviorState StopSprinting(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	AgentInfo agentInfo;
-	auto valid = pBlackboard->GetData("AgentInfo", agentInfo);
+	auto valid = pBoard->GetData(Keys::AgentInfo, agentInfo);
 
 	if (!valid)
 		return Failure;
 
 	agentInfo.RunMode = false;
-	pBlackboard->ChangeData("AgentInfo", agentInfo);
+	pBoard->ChangeData(Keys::AgentInfo, agentInfo);
 
 	return Success;
 }
@@ -942,13 +878,14 @@ BehaviorState StopSprinting(Blackboard* pBlackboard)
 //
 inline BehaviorState WanderAround(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	//Init data to null
 	SteeringBehaviours::Wander* pWanderBehaviour = nullptr;
 	SteeringBehaviours::ISteeringBehaviour* pCurrentBehaviour = nullptr;
 
 	//Get the required data
-	auto dataAvailable = pBlackboard->GetData("CurrentBehaviour", pCurrentBehaviour)
-		&& pBlackboard->GetData("WanderBehaviour", pWanderBehaviour);
+	auto dataAvailable = pBoard->GetData(Keys::CurrentBehaviour, pCurrentBehaviour)
+		&& pBoard->GetData(Keys::WanderBehaviour, pWanderBehaviour);
 
 	if (!dataAvailable)
 		return Failure;
@@ -958,24 +895,25 @@ inline BehaviorState WanderAround(Blackboard* pBlackboard)
 	//Perform action
 	if (pCurrentBehaviour != pWanderBehaviour)
 	{
-		printf("[STEERING CHANGE] Setting behaviour to Wander.\n");
+		LOG_INFO(LogCategory::Steering, "Setting behaviour to Wander.");
 		pCurrentBehaviour = pWanderBehaviour;
-		pBlackboard->ChangeData("CurrentBehaviour", pCurrentBehaviour);
+		pBoard->ChangeData(Keys::CurrentBehaviour, pCurrentBehaviour);
 	}
 
 	return Success;
 }
 inline BehaviorState LookAroundGoToTarget(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	//Init data to null
 	SteeringBehaviours::LookAround* pLookAroundBehaviour = nullptr;
 	SteeringBehaviours::ISteeringBehaviour* pCurrentBehaviour = nullptr;
 	b2Vec2 target = b2Vec2_zero;
 
 	//Get the required data
-	auto dataAvailable = pBlackboard->GetData("CurrentBehaviour", pCurrentBehaviour)
-		&& pBlackboard->GetData("LookAroundBehaviour", pLookAroundBehaviour)
-		&& pBlackboard->GetData("Target", target);
+	auto dataAvailable = pBoard->GetData(Keys::CurrentBehaviour, pCurrentBehaviour)
+		&& pBoard->GetData(Keys::LookAroundBehaviour, pLookAroundBehaviour)
+		&& pBoard->GetData(Keys::Target, target);
 
 	if (!dataAvailable)
 		return Failure;
@@ -987,24 +925,25 @@ inline BehaviorState LookAroundGoToTarget(Blackboard* pBlackboard)
 	//Perform action
 	if (pCurrentBehaviour != pLookAroundBehaviour)
 	{
-		printf("[STEERING CHANGE] Setting behaviour to LookAround.\n");
+		LOG_INFO(LogCategory::Steering, "Setting behaviour to LookAround.");
 		pCurrentBehaviour = pLookAroundBehaviour;
-		pBlackboard->ChangeData("CurrentBehaviour", pCurrentBehaviour);
+		pBoard->ChangeData(Keys::CurrentBehaviour, pCurrentBehaviour);
 	}
 
 	return Success;
 }
 inline BehaviorState GoToTarget(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	//Init data to null
 	SteeringBehaviours::Seek* pSeekBehaviour = nullptr;
 	SteeringBehaviours::ISteeringBehaviour* pCurrentBehaviour = nullptr;
 	b2Vec2 target = b2Vec2_zero;
 
 	//Get the required data
-	auto dataAvailable = pBlackboard->GetData("CurrentBehaviour", pCurrentBehaviour)
-		&& pBlackboard->GetData("SeekBehaviour", pSeekBehaviour)
-		&& pBlackboard->GetData("Target", target);
+	auto dataAvailable = pBoard->GetData(Keys::CurrentBehaviour, pCurrentBehaviour)
+		&& pBoard->GetData(Keys::SeekBehaviour, pSeekBehaviour)
+		&& pBoard->GetData(Keys::Target, target);
 
 	if (!dataAvailable)
 		return Failure;
@@ -1016,24 +955,25 @@ inline BehaviorState GoToTarget(Blackboard* pBlackboard)
 	//Perform action
 	if (pCurrentBehaviour != pSeekBehaviour)
 	{
-		printf("[STEERING CHANGE] Setting behaviour to Seek.\n");
+		LOG_INFO(LogCategory::Steering, "Setting behaviour to Seek.");
 		pCurrentBehaviour = pSeekBehaviour;
-		pBlackboard->ChangeData("CurrentBehaviour", pCurrentBehaviour);
+		pBoard->ChangeData(Keys::CurrentBehaviour, pCurrentBehaviour);
 	}
 
 	return Success;
 }
 inline BehaviorState ArriveAtTarget(Blackboard* pBlackboard)
 {
+	auto pBoard = AgentBlackboard::From(pBlackboard);
 	//Init data to null
 	SteeringBehaviours::Arrive* pArriveBehaviour = nullptr;
 	SteeringBehaviours::ISteeringBehaviour* pCurrentBehaviour = nullptr;
 	b2Vec2 target = b2Vec2_zero;
 
 	//Get the required data
-	auto dataAvailable = pBlackboard->GetData("CurrentBehaviour", pCurrentBehaviour)
-		&& pBlackboard->GetData("ArriveBehaviour", pArriveBehaviour)
-		&& pBlackboard->GetData("Target", target);
+	auto dataAvailable = pBoard->GetData(Keys::CurrentBehaviour, pCurrentBehaviour)
+		&& pBoard->GetData(Keys::ArriveBehaviour, pArriveBehaviour)
+		&& pBoard->GetData(Keys::Target, target);
 
 	if (!dataAvailable || !pArriveBehaviour)
 		return Failure;
@@ -1043,9 +983,9 @@ inline BehaviorState ArriveAtTarget(Blackboard* pBlackboard)
 	//Perform action
 	if (pCurrentBehaviour != pArriveBehaviour)
 	{
-		printf("[STEERING CHANGE] Setting behaviour to Arrive.\n");
+		LOG_INFO(LogCategory::Steering, "Setting behaviour to Arrive.");
 		pCurrentBehaviour = pArriveBehaviour;
-		pBlackboard->ChangeData("CurrentBehaviour", pCurrentBehaviour);
+		pBoard->ChangeData(Keys::CurrentBehaviour, pCurrentBehaviour);
 	}
 
 	return Success;
@@ -0,0 +1,169 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include <unordered_map>
+
+//Enemies in view on a uniform grid, so finding the ones around a point only looks at the cells it overlaps
+//Updated from what's in view every frame, an enemy only moves to another cell when it crossed into one
+class EnemyGrid final
+{
+public:
+	explicit EnemyGrid(float cellSize = 10.f)
+		: m_CellSize(cellSize)
+	{}
+
+	//Bring the grid in line with the enemies in view, the ones that aren't in it anymore are dropped
+	//Returns whether another set of enemies is in view than before, one coming into view or one dropping out
+	bool Update(const vector<EntityInfo>& enemies)
+	{
+		++m_Frame;
+		bool changed = false;
+
+		for (const auto& enemy : enemies)
+		{
+			const auto cell = ToKey(enemy.Position);
+			auto it = m_Indices.find(enemy.EntityHash);
+			if (it == m_Indices.end())
+			{
+				const auto index = static_cast<uint32_t>(m_Enemies.size());
+				m_Enemies.push_back({ enemy.Position, enemy.EntityHash, cell, m_Frame });
+				m_Indices[enemy.EntityHash] = index;
+				m_Cells[cell].push_back(index);
+				changed = true;
+				continue;
+			}
+
+			auto& entry = m_Enemies[it->second];
+			if (entry.Cell != cell)
+			{
+				EraseFromCell(entry.Cell, it->second);
+				m_Cells[cell].push_back(it->second);
+				entry.Cell = cell;
+			}
+			entry.Position = enemy.Position;
+			entry.SeenFrame = m_Frame;
+		}
+
+		//Going backwards, so the enemy moved into a hole has been looked at already
+		for (auto index = m_Enemies.size(); index-- > 0;)
+		{
+			if (m_Enemies[index].SeenFrame != m_Frame)
+			{
+				Remove(static_cast<uint32_t>(index));
+				changed = true;
+			}
+		}
+		return changed;
+	}
+
+	//Call fn with the position of every enemy within radius of center
+	template<typename Fn>
+	void ForEachInRadius(const b2Vec2& center, float radius, Fn fn) const
+	{
+		const float radiusSquared = radius * radius;
+		const int minX = Quantize(center.x - radius), maxX = Quantize(center.x + radius);
+		const int minY = Quantize(center.y - radius), maxY = Quantize(center.y + radius);
+
+		for (int x = minX; x <= maxX; ++x)
+		{
+			for (int y = minY; y <= maxY; ++y)
+			{
+				auto cell = m_Cells.find(ToKey(x, y));
+				if (cell == m_Cells.end())
+					continue;
+
+				for (auto index : cell->second)
+				{
+					if ((m_Enemies[index].Position - center).LengthSquared() <= radiusSquared)
+						fn(m_Enemies[index].Position);
+				}
+			}
+		}
+	}
+
+	bool AnyInRadius(const b2Vec2& center, float radius) const
+	{
+		bool found = false;
+		ForEachInRadius(center, radius, [&found](const b2Vec2&) { found = true; });
+		return found;
+	}
+
+	void Clear()
+	{
+		m_Enemies.clear();
+		m_Indices.clear();
+		m_Cells.clear();
+	}
+
+	size_t Size() const { return m_Enemies.size(); }
+	bool Empty() const { return m_Enemies.empty(); }
+
+private:
+	typedef uint64_t CellKey;
+
+	struct Enemy
+	{
+		b2Vec2 Position;
+		int Hash;
+		CellKey Cell;
+		uint32_t SeenFrame;
+	};
+
+	int Quantize(float value) const
+	{
+		return static_cast<int>(floor(value / m_CellSize));
+	}
+	CellKey ToKey(int x, int y) const
+	{
+		return (static_cast<CellKey>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+	CellKey ToKey(const b2Vec2& position) const
+	{
+		return ToKey(Quantize(position.x), Quantize(position.y));
+	}
+
+	//Move the last enemy into the hole so the storage stays dense
+	void Remove(uint32_t index)
+	{
+		EraseFromCell(m_Enemies[index].Cell, index);
+		m_Indices.erase(m_Enemies[index].Hash);
+
+		const auto last = static_cast<uint32_t>(m_Enemies.size() - 1);
+		if (index != last)
+		{
+			for (auto& cellIndex : m_Cells[m_Enemies[last].Cell])
+			{
+				if (cellIndex == last)
+				{
+					cellIndex = index;
+					break;
+				}
+			}
+			m_Indices[m_Enemies[last].Hash] = index;
+			m_Enemies[index] = m_Enemies[last];
+		}
+
+		m_Enemies.pop_back();
+	}
+
+	//Empty cells are kept, enemies keep walking through the same ones
+	void EraseFromCell(CellKey key, uint32_t index)
+	{
+		auto& cell = m_Cells[key];
+		for (auto it = cell.begin(); it != cell.end(); ++it)
+		{
+			if (*it == index)
+			{
+				*it = cell.back();
+				cell.pop_back();
+				return;
+			}
+		}
+	}
+
+	float m_CellSize;
+	uint32_t m_Frame = 0;
+	vector<Enemy> m_Enemies;
+	std::unordered_map<int, uint32_t> m_Indices;	//By entity hash
+	std::unordered_map<CellKey, vector<uint32_t>> m_Cells;
+};
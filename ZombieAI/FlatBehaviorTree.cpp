@@ -0,0 +1,436 @@
+#include "stdafx.h"
+#include "FlatBehaviorTree.h"
+#include "FlatTreeImage.h"
+
+#include <queue>
+#if FLATTREE_PROFILING
+#include <cstdio>
+#endif
+
+const uint16_t FlatBehaviorTree::NoNode;
+
+FlatBehaviorTree::FlatBehaviorTree(const FlatTreeNode& root)
+	: m_pOwnedImage(new FlatTreeImage())
+{
+	//Every leaf of the description is in the registry, so building can't fail
+	FlatLeafRegistry registry;
+	registry.AddLeaves(root);
+	m_pOwnedImage->Build(root, registry);
+
+	m_pImage = m_pOwnedImage.get();
+	m_ConditionMemos.assign(m_pImage->ConditionCount(), FlatConditionMemo());
+	m_PartialIndices.assign(m_pImage->PartialCount(), 0);
+	m_LastStates.assign(m_pImage->NodeCount(), Failure);
+#if FLATTREE_PROFILING
+	m_Profiles.assign(m_pImage->NodeCount(), FlatNodeProfile());
+#endif
+}
+
+FlatBehaviorTree::FlatBehaviorTree(const FlatTreeImage* pImage)
+	: m_pImage(pImage)
+{
+	//Only the running state is ours, everything else is read from the image
+	m_ConditionMemos.assign(m_pImage->ConditionCount(), FlatConditionMemo());
+	m_PartialIndices.assign(m_pImage->PartialCount(), 0);
+	m_LastStates.assign(m_pImage->NodeCount(), Failure);
+#if FLATTREE_PROFILING
+	m_Profiles.assign(m_pImage->NodeCount(), FlatNodeProfile());
+#endif
+}
+
+//Here, where the image is a complete type
+FlatBehaviorTree::~FlatBehaviorTree() = default;
+
+size_t FlatBehaviorTree::NodeCount() const
+{
+	return m_pImage->NodeCount();
+}
+
+const FlatNode& FlatBehaviorTree::GetNode(uint16_t index) const
+{
+	return m_pImage->GetNode(index);
+}
+
+void FlatBehaviorTree::Update(Blackboard* pBlackboard)
+{
+	auto pBoard = AgentBlackboard::From(pBlackboard);
+	const auto runningLeaf = m_RunningLeaf;
+	m_RunningLeaf = NoNode;
+#if FLATTREE_PROFILING
+	m_ChildNs = 0;
+#endif
+
+	//Only what changed since the last tick counts, the tree's own changes were cleared after it
+	if (m_EventDriven && runningLeaf != NoNode && (pBoard->GetChanges() & InterruptMask(runningLeaf)) == 0)
+	{
+		Resume(runningLeaf, pBlackboard);
+		++m_ResumedTicks;
+	}
+	else
+	{
+		Tick(0, pBlackboard);
+		++m_FullTicks;
+	}
+
+	pBoard->ClearChanges();
+}
+
+void FlatBehaviorTree::Reset()
+{
+	std::fill(m_PartialIndices.begin(), m_PartialIndices.end(), static_cast<uint16_t>(0));
+	m_RunningLeaf = NoNode;
+	m_LastLeaf = NoNode;
+
+	//The tree could be ticked with another blackboard from now on, its versions mean nothing to us
+	for (auto& memo : m_ConditionMemos)
+		memo.Valid = false;
+}
+
+void FlatBehaviorTree::SetEventDriven(bool eventDriven, BlackboardSlotMask interruptSlots)
+{
+	m_EventDriven = eventDriven;
+	m_InterruptSlots = interruptSlots;
+	m_RunningLeaf = NoNode;
+}
+
+BehaviorState FlatBehaviorTree::Tick(uint16_t nodeIndex, Blackboard* pBlackboard)
+{
+#if FLATTREE_PROFILING
+	//The children add their time to m_ChildNs, the parent's total is put back afterwards
+	const auto start = ProfileClock::now();
+	const auto parentChildNs = m_ChildNs;
+	m_ChildNs = 0;
+#endif
+
+	const auto& node = m_pImage->GetNode(nodeIndex);
+	const auto state = Evaluate(node, pBlackboard);
+	m_LastStates[nodeIndex] = state;
+
+	//The last leaf that kept running is where the next tick picks up
+	if (node.ChildCount == 0)
+	{
+		m_LastLeaf = nodeIndex;
+		if (state == Running)
+			m_RunningLeaf = nodeIndex;
+	}
+
+#if FLATTREE_PROFILING
+	const auto inclusiveNs = ElapsedNs(start);
+	RecordProfile(nodeIndex, state, inclusiveNs, inclusiveNs - std::min(m_ChildNs, inclusiveNs));
+	m_ChildNs = parentChildNs + inclusiveNs;
+#endif
+
+	return state;
+}
+
+BehaviorState FlatBehaviorTree::Evaluate(const FlatNode& node, Blackboard* pBlackboard)
+{
+	switch (node.Kind)
+	{
+	case FlatNodeKind::Selector:
+	case FlatNodeKind::DoAll:
+		return TickChildren(node, node.FirstChild, Failure, pBlackboard);
+
+	case FlatNodeKind::Sequence:
+	case FlatNodeKind::AlwaysTrue:
+	case FlatNodeKind::RunningIsGood:
+		return TickChildren(node, node.FirstChild, Success, pBlackboard);
+
+	case FlatNodeKind::PartialSequence:
+	{
+		//One child per tick, remembers where it was
+		auto& current = m_PartialIndices[node.Payload];
+		if (current >= node.ChildCount)
+		{
+			current = 0;
+			return Success;
+		}
+
+		return FinishPartial(node, Tick(node.FirstChild + current, pBlackboard));
+	}
+
+	case FlatNodeKind::Conditional:
+		return EvaluateCondition(node.Payload, pBlackboard) ? Success : Failure;
+
+	case FlatNodeKind::Action:
+		return m_pImage->GetAction(node.Payload)(pBlackboard);
+
+	case FlatNodeKind::ActionInverse:
+		switch (m_pImage->GetAction(node.Payload)(pBlackboard))
+		{
+		case Success:
+			return Failure;
+		case Failure:
+			return Success;
+		default:
+			return Running;
+		}
+	}
+
+	return Failure;
+}
+
+bool FlatBehaviorTree::EvaluateCondition(uint16_t condition, Blackboard* pBlackboard)
+{
+	const auto inputs = m_pImage->GetConditionInputs(condition);
+	if (inputs == 0)
+		return m_pImage->GetCondition(condition)(pBlackboard);
+
+	auto& memo = m_ConditionMemos[condition];
+	const auto version = AgentBlackboard::From(pBlackboard)->GetVersion(inputs);
+	if (!memo.Valid || memo.Version != version)
+	{
+		memo.Result = m_pImage->GetCondition(condition)(pBlackboard);
+		memo.Version = version;
+		memo.Valid = true;
+	}
+	return memo.Result;
+}
+
+BehaviorState FlatBehaviorTree::TickChildren(const FlatNode& node, uint16_t child, BehaviorState state, Blackboard* pBlackboard)
+{
+	const uint16_t endChild = node.FirstChild + node.ChildCount;
+
+	switch (node.Kind)
+	{
+	case FlatNodeKind::Selector:
+		//First child that doesn't fail
+		for (; child < endChild && state == Failure; ++child)
+			state = Tick(child, pBlackboard);
+		return state;
+
+	case FlatNodeKind::Sequence:
+	case FlatNodeKind::AlwaysTrue:
+	case FlatNodeKind::RunningIsGood:
+		//Every child in order, stops at the first one that doesn't succeed
+		for (; child < endChild && state == Success; ++child)
+			state = Tick(child, pBlackboard);
+
+		if (node.Kind == FlatNodeKind::AlwaysTrue)
+			return Success;
+		if (node.Kind == FlatNodeKind::RunningIsGood && state == Running)
+			return Success;
+		return state;
+
+	case FlatNodeKind::DoAll:
+		//Every child, succeeds if any of them did
+		for (; child < endChild; ++child)
+		{
+			if (Tick(child, pBlackboard) == Success)
+				state = Success;
+		}
+		return state;
+
+	default:
+		return state;
+	}
+}
+
+BehaviorState FlatBehaviorTree::FinishPartial(const FlatNode& node, BehaviorState childState)
+{
+	auto& current = m_PartialIndices[node.Payload];
+	switch (childState)
+	{
+	case Failure:
+		current = 0;
+		return Failure;
+	case Success:
+		++current;
+		return Running;
+	default:
+		return Running;
+	}
+}
+
+BehaviorState FlatBehaviorTree::Continue(uint16_t nodeIndex, uint16_t child, BehaviorState childState, Blackboard* pBlackboard)
+{
+	const auto& node = m_pImage->GetNode(nodeIndex);
+	auto state = childState;
+
+	switch (node.Kind)
+	{
+	case FlatNodeKind::PartialSequence:
+		state = FinishPartial(node, childState);
+		break;
+
+	case FlatNodeKind::DoAll:
+		//The children before this one weren't ticked, they count as what they returned last time
+		for (auto earlier = node.FirstChild; earlier < child; ++earlier)
+		{
+			if (m_LastStates[earlier] == Success)
+				state = Success;
+		}
+		state = TickChildren(node, child + 1, state == Success ? Success : Failure, pBlackboard);
+		break;
+
+	default:
+		state = TickChildren(node, child + 1, childState, pBlackboard);
+		break;
+	}
+
+	m_LastStates[nodeIndex] = state;
+	return state;
+}
+
+BehaviorState FlatBehaviorTree::Resume(uint16_t leaf, Blackboard* pBlackboard)
+{
+	auto child = leaf;
+	auto state = Tick(child, pBlackboard);
+	while (child != 0)
+	{
+		const auto parent = m_pImage->GetParent(child);
+#if FLATTREE_PROFILING
+		//Everything below the parent so far already ran, the siblings it ticks now add to that
+		const auto start = ProfileClock::now();
+		const auto belowNs = m_ChildNs;
+		m_ChildNs = 0;
+#endif
+		state = Continue(parent, child, state, pBlackboard);
+#if FLATTREE_PROFILING
+		const auto ownNs = ElapsedNs(start);
+		RecordProfile(parent, state, belowNs + ownNs, ownNs - std::min(m_ChildNs, ownNs));
+		m_ChildNs = belowNs + ownNs;
+#endif
+		child = parent;
+	}
+
+	return state;
+}
+
+BlackboardSlotMask FlatBehaviorTree::InterruptMask(uint16_t leaf) const
+{
+	auto mask = m_InterruptSlots;
+	for (auto node = leaf; node != 0; node = m_pImage->GetParent(node))
+	{
+		//A partial sequence doesn't go back to the children it's done with, so they can't take over
+		if (m_pImage->GetNode(m_pImage->GetParent(node)).Kind != FlatNodeKind::PartialSequence)
+			mask |= m_pImage->GetEarlierWatches(node);
+	}
+	return mask;
+}
+
+size_t FlatBehaviorTree::GetActivePath(uint16_t* pPath, size_t maxDepth) const
+{
+	if (m_LastLeaf == NoNode)
+		return 0;
+
+	size_t length = 1;
+	for (auto node = m_LastLeaf; node != 0; node = m_pImage->GetParent(node))
+		++length;
+
+	//Walk up from the leaf, filling the path from its end
+	auto depth = length;
+	for (auto node = m_LastLeaf; depth-- > 0; node = m_pImage->GetParent(node))
+	{
+		if (depth < maxDepth)
+			pPath[depth] = node;
+	}
+
+	return std::min(length, maxDepth);
+}
+
+uint32_t FlatBehaviorTree::LayoutHash() const
+{
+	return m_pImage->LayoutHash();
+}
+
+vector<const char*> FlatBehaviorTree::NodeNames(const FlatTreeNode& root)
+{
+	//Same breadth first order the image lays the nodes out in
+	vector<const char*> names;
+	std::queue<const FlatTreeNode*> toName;
+	toName.push(&root);
+
+	while (!toName.empty())
+	{
+		const auto pDesc = toName.front();
+		toName.pop();
+
+		names.push_back(pDesc->Name ? pDesc->Name : KindName(pDesc->Kind));
+		for (const auto& child : pDesc->Children)
+			toName.push(&child);
+	}
+	return names;
+}
+
+const char* FlatBehaviorTree::KindName(FlatNodeKind kind)
+{
+	switch (kind)
+	{
+	case FlatNodeKind::Selector: return "Selector";
+	case FlatNodeKind::Sequence: return "Sequence";
+	case FlatNodeKind::PartialSequence: return "PartialSequence";
+	case FlatNodeKind::AlwaysTrue: return "AlwaysTrue";
+	case FlatNodeKind::RunningIsGood: return "RunningIsGood";
+	case FlatNodeKind::DoAll: return "DoAll";
+	case FlatNodeKind::Conditional: return "Conditional";
+	case FlatNodeKind::Action: return "Action";
+	case FlatNodeKind::ActionInverse: return "ActionInverse";
+	}
+	return "Unknown";
+}
+
+#if FLATTREE_PROFILING
+const char* FlatBehaviorTree::GetNodeName(uint16_t index) const
+{
+	return m_pImage->GetNodeName(index);
+}
+
+void FlatBehaviorTree::ResetProfile()
+{
+	std::fill(m_Profiles.begin(), m_Profiles.end(), FlatNodeProfile());
+}
+
+bool FlatBehaviorTree::WriteProfile(const string& path) const
+{
+	auto pFile = fopen(path.c_str(), "w");
+	if (!pFile)
+		return false;
+
+	fprintf(pFile, "%-48s %10s %12s %12s %10s %10s %10s\n", "Node", "Ticks", "Incl ms", "Excl ms", "Success", "Failure", "Running");
+	WriteProfileNode(pFile, 0, 0);
+	fclose(pFile);
+	return true;
+}
+
+uint64_t FlatBehaviorTree::ElapsedNs(ProfileClock::time_point start)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(ProfileClock::now() - start).count());
+}
+
+void FlatBehaviorTree::RecordProfile(uint16_t nodeIndex, BehaviorState state, uint64_t inclusiveNs, uint64_t exclusiveNs)
+{
+	auto& profile = m_Profiles[nodeIndex];
+	++profile.Ticks;
+	profile.InclusiveNs += inclusiveNs;
+	profile.ExclusiveNs += exclusiveNs;
+
+	switch (state)
+	{
+	case Success:
+		++profile.Successes;
+		break;
+	case Failure:
+		++profile.Failures;
+		break;
+	default:
+		++profile.Running;
+		break;
+	}
+}
+
+void FlatBehaviorTree::WriteProfileNode(FILE* pFile, uint16_t nodeIndex, int depth) const
+{
+	const auto& node = m_pImage->GetNode(nodeIndex);
+	const auto& profile = m_Profiles[nodeIndex];
+
+	fprintf(pFile, "%*s%-*s %10llu %12.3f %12.3f %10llu %10llu %10llu\n",
+		depth * 2, "", 48 - depth * 2, m_pImage->GetNodeName(nodeIndex),
+		static_cast<unsigned long long>(profile.Ticks), profile.InclusiveNs / 1e6, profile.ExclusiveNs / 1e6,
+		static_cast<unsigned long long>(profile.Successes), static_cast<unsigned long long>(profile.Failures),
+		static_cast<unsigned long long>(profile.Running));
+
+	for (uint16_t child = node.FirstChild; child < node.FirstChild + node.ChildCount; ++child)
+		WriteProfileNode(pFile, child, depth + 1);
+}
+#endif
@@ -0,0 +1,218 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include <memory>
+#include "Blackboard.h"
+#include "BehaviorTree.h"
+#include "AgentBlackboard.h"
+
+/*
+ * FLAT BEHAVIOUR TREE
+ * A built tree compiled into one contiguous array of compact nodes
+ * The children of a node are stored next to each other, so a node only keeps the index range of its children
+ * Ticking walks the array instead of chasing pointers between separately allocated nodes
+ *
+ * Event driven, the tree doesn't start from the root every tick
+ * When a leaf returned running, the next tick resumes that leaf and only finishes the composites above it
+ * Every leaf lists the blackboard entries its outcome depends on, the branches before the running leaf are only
+ * re-checked when one of their entries changed or an interrupt entry changed, and then they abort the running leaf
+ *
+ * Conditions that declare the entries they read are memoized, they're only called again once one of those changed
+ *
+ * The compiled nodes live in a FlatTreeImage that any number of trees can share, a tree only keeps its running state
+ */
+
+#pragma region defines
+//Count ticks, time and outcomes of every node
+//Compiled out when 0, the tree doesn't even keep the node names then
+#ifndef FLATTREE_PROFILING
+#define FLATTREE_PROFILING 0
+#endif
+
+#if FLATTREE_PROFILING
+#include <chrono>
+#endif
+#pragma endregion
+
+typedef bool(*FlatConditionFn)(Blackboard*);
+typedef BehaviorState(*FlatActionFn)(Blackboard*);
+
+//Same node kinds as the dynamic tree
+enum class FlatNodeKind : uint8_t
+{
+	Selector,
+	Sequence,
+	PartialSequence,
+	AlwaysTrue,
+	RunningIsGood,
+	DoAll,
+	Conditional,
+	Action,
+	ActionInverse
+};
+
+#pragma region DESCRIPTION
+//Description of a tree, only used to build the flat tree
+struct FlatTreeNode
+{
+	FlatTreeNode(FlatNodeKind kind, std::initializer_list<FlatTreeNode> children)
+		: Kind(kind)
+		, Children(children)
+	{}
+
+	static FlatTreeNode Leaf(FlatNodeKind kind, FlatConditionFn condition)
+	{
+		FlatTreeNode node(kind, {});
+		node.Condition = condition;
+		return node;
+	}
+	static FlatTreeNode Leaf(FlatNodeKind kind, FlatActionFn action)
+	{
+		FlatTreeNode node(kind, {});
+		node.Action = action;
+		return node;
+	}
+
+	FlatNodeKind Kind;
+	FlatConditionFn Condition = nullptr;
+	FlatActionFn Action = nullptr;
+	BlackboardSlotMask Watches = 0;	//Entries the outcome of this leaf depends on
+	BlackboardSlotMask Inputs = 0;	//Conditions: every entry it reads, to memoize it on, 0 calls it every tick
+	const char* Name = nullptr;	//Leaves: name of the function, shown when profiling
+	vector<FlatTreeNode> Children;
+};
+#pragma endregion
+
+#pragma region FLATTREE
+//Compact node, 8 bytes
+struct FlatNode
+{
+	FlatNodeKind Kind;
+	uint8_t Padding;
+	uint16_t Payload;	//Leaves: index in the condition or action table, partial sequences: index of their state
+	uint16_t FirstChild;
+	uint16_t ChildCount;
+};
+
+//Last outcome of a memoized condition and the version of its inputs it was worked out for
+struct FlatConditionMemo
+{
+	uint64_t Version = 0;
+	bool Result = false;
+	bool Valid = false;
+};
+
+#if FLATTREE_PROFILING
+//What one node did since the profile was last reset
+//Resumed ticks count for the running leaf and every composite above it
+struct FlatNodeProfile
+{
+	uint64_t Ticks = 0;
+	uint64_t InclusiveNs = 0;	//In the node and everything under it
+	uint64_t ExclusiveNs = 0;	//In the node itself
+	uint64_t Successes = 0;
+	uint64_t Failures = 0;
+	uint64_t Running = 0;
+};
+#endif
+
+class FlatTreeImage;
+
+class FlatBehaviorTree final
+{
+public:
+	//Compiles the description into an image of its own
+	explicit FlatBehaviorTree(const FlatTreeNode& root);
+	//Runs a compiled image, which has to outlive the tree
+	explicit FlatBehaviorTree(const FlatTreeImage* pImage);
+	~FlatBehaviorTree();
+
+	//Tick the tree once, like BehaviorTree::Update
+	//Resumes the running leaf when event driven and nothing it depends on changed
+	//Expects an AgentBlackboard, its changes are cleared after every tick
+	void Update(Blackboard* pBlackboard);
+
+	//Forget the state of every partial sequence, the running leaf and every memoized condition
+	void Reset();
+
+	//Resume running leaves instead of ticking from the root
+	//A change to any of the interrupt entries always restarts from the root
+	void SetEventDriven(bool eventDriven, BlackboardSlotMask interruptSlots = 0);
+
+	const FlatTreeImage* GetImage() const { return m_pImage; }
+	size_t NodeCount() const;
+	const FlatNode& GetNode(uint16_t index) const;
+
+	//Nodes from the root down to the leaf the last tick ended on, returns how many were written
+	//Deeper paths are cut off at maxDepth
+	size_t GetActivePath(uint16_t* pPath, size_t maxDepth) const;
+	//Changes whenever the shape of the tree does, to tell whether node indices saved earlier still mean the same
+	uint32_t LayoutHash() const;
+	//Name of every node of the tree built from root, by node index
+	//Leaves use their own name, composites the name of their kind
+	static vector<const char*> NodeNames(const FlatTreeNode& root);
+	static const char* KindName(FlatNodeKind kind);
+	size_t FullTicks() const { return m_FullTicks; }
+	size_t ResumedTicks() const { return m_ResumedTicks; }
+
+#if FLATTREE_PROFILING
+	const char* GetNodeName(uint16_t index) const;
+	const FlatNodeProfile& GetProfile(uint16_t index) const { return m_Profiles[index]; }
+	void ResetProfile();
+	//Every node as an indented tree with its counters, returns false if the file can't be written
+	bool WriteProfile(const string& path) const;
+#endif
+
+private:
+	static const uint16_t NoNode = UINT16_MAX;
+
+	BehaviorState Tick(uint16_t nodeIndex, Blackboard* pBlackboard);
+	BehaviorState Evaluate(const FlatNode& node, Blackboard* pBlackboard);
+	//Calls the condition, or hands back its last outcome if none of its inputs changed since
+	bool EvaluateCondition(uint16_t condition, Blackboard* pBlackboard);
+
+	//Ticks the children of a composite from child onwards, state is what the children before it came to
+	BehaviorState TickChildren(const FlatNode& node, uint16_t child, BehaviorState state, Blackboard* pBlackboard);
+	//What a partial sequence returns after its current child returned childState
+	BehaviorState FinishPartial(const FlatNode& node, BehaviorState childState);
+	//Finishes a composite after one of its children returned childState
+	BehaviorState Continue(uint16_t nodeIndex, uint16_t child, BehaviorState childState, Blackboard* pBlackboard);
+
+	//Ticks the running leaf and finishes every composite above it
+	BehaviorState Resume(uint16_t leaf, Blackboard* pBlackboard);
+	//Entries that abort the running leaf when they change
+	BlackboardSlotMask InterruptMask(uint16_t leaf) const;
+
+#if FLATTREE_PROFILING
+	typedef std::chrono::high_resolution_clock ProfileClock;
+
+	static uint64_t ElapsedNs(ProfileClock::time_point start);
+	void RecordProfile(uint16_t nodeIndex, BehaviorState state, uint64_t inclusiveNs, uint64_t exclusiveNs);
+	void WriteProfileNode(FILE* pFile, uint16_t nodeIndex, int depth) const;
+#endif
+
+	//Only set when the tree compiled its own description
+	std::unique_ptr<FlatTreeImage> m_pOwnedImage;
+	const FlatTreeImage* m_pImage = nullptr;
+
+	vector<FlatConditionMemo> m_ConditionMemos;	//One per condition
+
+	//Current child of every partial sequence
+	vector<uint16_t> m_PartialIndices;
+
+	//Event driven bookkeeping, one per node
+	vector<BehaviorState> m_LastStates;
+
+	bool m_EventDriven = false;
+	BlackboardSlotMask m_InterruptSlots = 0;
+	uint16_t m_RunningLeaf = NoNode;
+	uint16_t m_LastLeaf = NoNode;
+	size_t m_FullTicks = 0;
+	size_t m_ResumedTicks = 0;
+
+#if FLATTREE_PROFILING
+	vector<FlatNodeProfile> m_Profiles;
+	uint64_t m_ChildNs = 0;	//Time spent in the children of the node that's being ticked
+#endif
+};
+#pragma endregion
@@ -0,0 +1,551 @@
+#include "stdafx.h"
+#include "FlatTreeImage.h"
+
+#include <cstring>
+#include <queue>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(FlatNode) == 8, "FlatNode is saved as is, its layout can't change");
+
+const uint16_t FlatLeafRegistry::InvalidLeaf;
+
+#pragma region Registry
+uint16_t FlatLeafRegistry::Add(const Condition& condition)
+{
+	m_Conditions.push_back(condition);
+	return static_cast<uint16_t>(m_Conditions.size() - 1);
+}
+
+uint16_t FlatLeafRegistry::Add(const Action& action)
+{
+	m_Actions.push_back(action);
+	return static_cast<uint16_t>(m_Actions.size() - 1);
+}
+
+void FlatLeafRegistry::AddLeaves(const FlatTreeNode& root)
+{
+	switch (root.Kind)
+	{
+	case FlatNodeKind::Conditional:
+		if (FindCondition(root.Condition) == InvalidLeaf)
+			Add(Condition{ root.Condition, root.Name, root.Watches, root.Inputs });
+		break;
+	case FlatNodeKind::Action:
+	case FlatNodeKind::ActionInverse:
+		if (FindAction(root.Action) == InvalidLeaf)
+			Add(Action{ root.Action, root.Name, root.Watches });
+		break;
+	default:
+		break;
+	}
+
+	for (const auto& child : root.Children)
+		AddLeaves(child);
+}
+
+uint16_t FlatLeafRegistry::FindCondition(FlatConditionFn function) const
+{
+	for (size_t id = 0; id < m_Conditions.size(); ++id)
+	{
+		if (m_Conditions[id].Function == function)
+			return static_cast<uint16_t>(id);
+	}
+	return InvalidLeaf;
+}
+
+uint16_t FlatLeafRegistry::FindAction(FlatActionFn function) const
+{
+	for (size_t id = 0; id < m_Actions.size(); ++id)
+	{
+		if (m_Actions[id].Function == function)
+			return static_cast<uint16_t>(id);
+	}
+	return InvalidLeaf;
+}
+
+uint32_t FlatLeafRegistry::Hash() const
+{
+	//FNV-1a over the name and entries of every leaf, the functions themselves move between builds
+	uint32_t hash = 2166136261u;
+	auto addByte = [&hash](uint8_t byte)
+	{
+		hash ^= byte;
+		hash *= 16777619u;
+	};
+	auto addName = [&addByte](const char* pName)
+	{
+		for (auto pChar = pName ? pName : ""; *pChar; ++pChar)
+			addByte(static_cast<uint8_t>(*pChar));
+		addByte(0);
+	};
+	auto addMask = [&addByte](BlackboardSlotMask mask)
+	{
+		for (int byte = 0; byte < 8; ++byte)
+			addByte(static_cast<uint8_t>(mask >> (byte * 8)));
+	};
+
+	for (const auto& condition : m_Conditions)
+	{
+		addName(condition.Name);
+		addMask(condition.Watches);
+		addMask(condition.Inputs);
+	}
+	addByte(0xFF);
+	for (const auto& action : m_Actions)
+	{
+		addName(action.Name);
+		addMask(action.Watches);
+	}
+	return hash;
+}
+#pragma endregion
+
+#pragma region Image
+FlatTreeImage::~FlatTreeImage()
+{
+	Clear();
+}
+
+bool FlatTreeImage::Build(const FlatTreeNode& root, const FlatLeafRegistry& registry, uint32_t sourceHash)
+{
+	Clear();
+
+	//Breadth first, so the children of every node end up next to each other
+	std::queue<std::pair<const FlatTreeNode*, uint16_t>> toCompile;
+	vector<FlatNode> nodes;
+	vector<uint16_t> parents;
+	vector<BlackboardSlotMask> watches;
+	vector<uint16_t> conditionIds;
+	vector<BlackboardSlotMask> conditionInputs;
+	vector<uint16_t> actionIds;
+	uint32_t partialCount = 0;
+
+	nodes.push_back(FlatNode());
+	parents.push_back(UINT16_MAX);
+	watches.push_back(0);
+	toCompile.push({ &root, 0 });
+
+	while (!toCompile.empty())
+	{
+		const auto pDesc = toCompile.front().first;
+		const auto index = toCompile.front().second;
+		toCompile.pop();
+
+		FlatNode node = {};
+		node.Kind = pDesc->Kind;
+
+		switch (pDesc->Kind)
+		{
+		case FlatNodeKind::Conditional:
+			node.Payload = static_cast<uint16_t>(conditionIds.size());
+			conditionIds.push_back(registry.FindCondition(pDesc->Condition));
+			conditionInputs.push_back(pDesc->Inputs);
+			if (conditionIds.back() == FlatLeafRegistry::InvalidLeaf)
+				return false;
+			break;
+		case FlatNodeKind::Action:
+		case FlatNodeKind::ActionInverse:
+			node.Payload = static_cast<uint16_t>(actionIds.size());
+			actionIds.push_back(registry.FindAction(pDesc->Action));
+			if (actionIds.back() == FlatLeafRegistry::InvalidLeaf)
+				return false;
+			break;
+		case FlatNodeKind::PartialSequence:
+			node.Payload = static_cast<uint16_t>(partialCount++);
+			break;
+		default:
+			break;
+		}
+
+		//Reserve a contiguous range for the children, they're filled in when they come out of the queue
+		node.FirstChild = static_cast<uint16_t>(nodes.size());
+		node.ChildCount = static_cast<uint16_t>(pDesc->Children.size());
+		if (nodes.size() + pDesc->Children.size() >= UINT16_MAX)
+			return false;
+
+		for (const auto& child : pDesc->Children)
+		{
+			toCompile.push({ &child, static_cast<uint16_t>(nodes.size()) });
+			nodes.push_back(FlatNode());
+			parents.push_back(index);
+			watches.push_back(0);
+		}
+
+		nodes[index] = node;
+		watches[index] = pDesc->Watches;
+	}
+
+	//Children always come after their parent, so going backwards gathers the watches of every subtree
+	for (auto index = nodes.size(); index-- > 1;)
+		watches[parents[index]] |= watches[index];
+
+	//Everything the siblings before a node watch, those are the branches that can take over from it
+	vector<BlackboardSlotMask> earlierWatches(nodes.size(), 0);
+	for (const auto& node : nodes)
+	{
+		BlackboardSlotMask earlier = 0;
+		for (uint16_t child = node.FirstChild; child < node.FirstChild + node.ChildCount; ++child)
+		{
+			earlierWatches[child] = earlier;
+			earlier |= watches[child];
+		}
+	}
+
+	//Laid out exactly like the file, so a built image and a loaded one are read the same way
+	const auto size = ImageSize(nodes.size(), conditionIds.size(), actionIds.size());
+	m_Buffer.assign((size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+
+	FileHeader header = {};
+	header.Magic = FileHeader::FileMagic;
+	header.Version = FileHeader::FileVersion;
+	header.RegistryHash = registry.Hash();
+	header.SourceHash = sourceHash;
+	header.NodeCount = static_cast<uint32_t>(nodes.size());
+	header.ConditionCount = static_cast<uint32_t>(conditionIds.size());
+	header.ActionCount = static_cast<uint32_t>(actionIds.size());
+	header.PartialCount = partialCount;
+
+	auto pWrite = reinterpret_cast<char*>(m_Buffer.data());
+	auto write = [&pWrite](const void* pData, size_t bytes)
+	{
+		if (bytes > 0)
+			memcpy(pWrite, pData, bytes);
+		pWrite += bytes;
+	};
+	write(&header, sizeof(header));
+	write(earlierWatches.data(), earlierWatches.size() * sizeof(BlackboardSlotMask));
+	write(conditionInputs.data(), conditionInputs.size() * sizeof(BlackboardSlotMask));
+	write(nodes.data(), nodes.size() * sizeof(FlatNode));
+	write(parents.data(), parents.size() * sizeof(uint16_t));
+	write(conditionIds.data(), conditionIds.size() * sizeof(uint16_t));
+	write(actionIds.data(), actionIds.size() * sizeof(uint16_t));
+	reinterpret_cast<FileHeader*>(m_Buffer.data())->Checksum = Checksum(m_Buffer.data(), size);
+
+	if (!SetView(m_Buffer.data(), size) || !Resolve(registry))
+	{
+		Clear();
+		return false;
+	}
+	return true;
+}
+
+bool FlatTreeImage::Load(const string& path, const FlatLeafRegistry& registry, uint32_t sourceHash, FlatTreeImageError* pError)
+{
+	Clear();
+	auto fail = [this, pError](FlatTreeImageError error)
+	{
+		Clear();
+		if (pError)
+			*pError = error;
+		return false;
+	};
+	const void* pView = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return fail(FlatTreeImageError::Missing);
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader)))
+	{
+		CloseHandle(file);
+		return fail(FlatTreeImageError::NotAnImage);
+	}
+	size = static_cast<size_t>(fileSize.QuadPart);
+
+	auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return fail(FlatTreeImageError::Unmappable);
+	}
+
+	pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+	if (!pView)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return fail(FlatTreeImageError::Unmappable);
+	}
+
+	m_pFile = file;
+	m_pMapping = mapping;
+#else
+	const auto file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return fail(FlatTreeImageError::Missing);
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(FileHeader)))
+	{
+		close(file);
+		return fail(FlatTreeImageError::NotAnImage);
+	}
+	size = static_cast<size_t>(fileStat.st_size);
+
+	pView = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+	if (pView == MAP_FAILED)
+	{
+		close(file);
+		return fail(FlatTreeImageError::Unmappable);
+	}
+
+	m_pFile = reinterpret_cast<void*>(static_cast<intptr_t>(file));
+#endif
+
+	m_pView = pView;
+	m_MappedSize = size;
+
+	const auto pHeader = static_cast<const FileHeader*>(pView);
+	if (pHeader->Magic != FileHeader::FileMagic || pHeader->Version != FileHeader::FileVersion)
+		return fail(FlatTreeImageError::NotAnImage);
+	if (pHeader->RegistryHash != registry.Hash())
+		return fail(FlatTreeImageError::OtherRegistry);
+	if (pHeader->SourceHash != sourceHash)
+		return fail(FlatTreeImageError::OtherSource);
+	if (!SetView(pView, size) || pHeader->Checksum != Checksum(pView, size) || !Resolve(registry))
+		return fail(FlatTreeImageError::Damaged);
+
+	if (pError)
+		*pError = FlatTreeImageError::None;
+	return true;
+}
+
+bool FlatTreeImage::Save(const string& path) const
+{
+	if (!m_pHeader)
+		return false;
+
+	auto pFile = fopen(path.c_str(), "wb");
+	if (!pFile)
+		return false;
+
+	const auto size = ImageSize(NodeCount(), ConditionCount(), ActionCount());
+	const auto written = fwrite(m_pHeader, 1, size, pFile) == size;
+	fclose(pFile);
+	return written;
+}
+
+uint32_t FlatTreeImage::LayoutHash() const
+{
+	//FNV-1a over the kind and children of every node
+	uint32_t hash = 2166136261u;
+	auto add = [&hash](uint32_t value)
+	{
+		for (int byte = 0; byte < 4; ++byte)
+		{
+			hash ^= (value >> (byte * 8)) & 0xFF;
+			hash *= 16777619u;
+		}
+	};
+
+	for (size_t index = 0; index < NodeCount(); ++index)
+	{
+		const auto& node = m_pNodes[index];
+		add(static_cast<uint32_t>(node.Kind));
+		add(node.FirstChild);
+		add(node.ChildCount);
+	}
+	return hash;
+}
+
+const char* FlatTreeImage::ErrorName(FlatTreeImageError error)
+{
+	switch (error)
+	{
+	case FlatTreeImageError::None: return "fine";
+	case FlatTreeImageError::Missing: return "missing";
+	case FlatTreeImageError::Unmappable: return "not mappable";
+	case FlatTreeImageError::NotAnImage: return "not a tree image";
+	case FlatTreeImageError::OtherRegistry: return "saved for other leaves";
+	case FlatTreeImageError::OtherSource: return "saved from another tree";
+	case FlatTreeImageError::Damaged: return "damaged";
+	}
+	return "unknown";
+}
+
+uint32_t FlatTreeImage::DescriptionHash(const FlatTreeNode& root)
+{
+	//FNV-1a over every node depth first, with the number of children so the shape can't be mistaken for another
+	uint32_t hash = 2166136261u;
+	auto addByte = [&hash](uint8_t byte)
+	{
+		hash ^= byte;
+		hash *= 16777619u;
+	};
+
+	vector<const FlatTreeNode*> toHash(1, &root);
+	while (!toHash.empty())
+	{
+		const auto pDesc = toHash.back();
+		toHash.pop_back();
+
+		addByte(static_cast<uint8_t>(pDesc->Kind));
+		addByte(static_cast<uint8_t>(pDesc->Children.size()));
+		addByte(static_cast<uint8_t>(pDesc->Children.size() >> 8));
+		for (auto pChar = pDesc->Name ? pDesc->Name : ""; *pChar; ++pChar)
+			addByte(static_cast<uint8_t>(*pChar));
+		addByte(0);
+
+		for (auto child = pDesc->Children.rbegin(); child != pDesc->Children.rend(); ++child)
+			toHash.push_back(&*child);
+	}
+	return hash;
+}
+
+size_t FlatTreeImage::ImageSize(size_t nodeCount, size_t conditionCount, size_t actionCount)
+{
+	return sizeof(FileHeader)
+		+ (nodeCount + conditionCount) * sizeof(BlackboardSlotMask)
+		+ nodeCount * sizeof(FlatNode)
+		+ (nodeCount + conditionCount + actionCount) * sizeof(uint16_t);
+}
+
+uint32_t FlatTreeImage::Checksum(const void* pData, size_t size)
+{
+	//FNV-1a, a flipped bit in a watch mask would still pass every other check
+	uint32_t hash = 2166136261u;
+	const auto pBytes = static_cast<const uint8_t*>(pData);
+	for (auto offset = sizeof(FileHeader); offset < size; ++offset)
+	{
+		hash ^= pBytes[offset];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+bool FlatTreeImage::SetView(const void* pData, size_t size)
+{
+	const auto pHeader = static_cast<const FileHeader*>(pData);
+	if (pHeader->NodeCount == 0 || pHeader->NodeCount >= UINT16_MAX
+		|| size != ImageSize(pHeader->NodeCount, pHeader->ConditionCount, pHeader->ActionCount))
+		return false;
+
+	auto pRead = reinterpret_cast<const char*>(pHeader + 1);
+	auto next = [&pRead](size_t bytes)
+	{
+		const auto pArray = pRead;
+		pRead += bytes;
+		return pArray;
+	};
+
+	m_pHeader = pHeader;
+	m_pEarlierWatches = reinterpret_cast<const BlackboardSlotMask*>(next(pHeader->NodeCount * sizeof(BlackboardSlotMask)));
+	m_pConditionInputs = reinterpret_cast<const BlackboardSlotMask*>(next(pHeader->ConditionCount * sizeof(BlackboardSlotMask)));
+	m_pNodes = reinterpret_cast<const FlatNode*>(next(pHeader->NodeCount * sizeof(FlatNode)));
+	m_pParents = reinterpret_cast<const uint16_t*>(next(pHeader->NodeCount * sizeof(uint16_t)));
+	m_pConditionIds = reinterpret_cast<const uint16_t*>(next(pHeader->ConditionCount * sizeof(uint16_t)));
+	m_pActionIds = reinterpret_cast<const uint16_t*>(next(pHeader->ActionCount * sizeof(uint16_t)));
+	return true;
+}
+
+bool FlatTreeImage::Resolve(const FlatLeafRegistry& registry)
+{
+	m_Conditions.clear();
+	m_Actions.clear();
+	m_Names.clear();
+
+	for (size_t condition = 0; condition < ConditionCount(); ++condition)
+	{
+		if (m_pConditionIds[condition] >= registry.ConditionCount())
+			return false;
+		m_Conditions.push_back(registry.GetCondition(m_pConditionIds[condition]).Function);
+	}
+	for (size_t action = 0; action < ActionCount(); ++action)
+	{
+		if (m_pActionIds[action] >= registry.ActionCount())
+			return false;
+		m_Actions.push_back(registry.GetAction(m_pActionIds[action]).Function);
+	}
+
+	//A damaged file could send the tree anywhere, every index has to stay in range
+	//The tree also counts on parents coming before their children, walking up always ends at the root
+	const auto nodeCount = NodeCount();
+	if (m_pParents[0] != UINT16_MAX)
+		return false;
+
+	for (size_t index = 0; index < nodeCount; ++index)
+	{
+		const auto& node = m_pNodes[index];
+		if (index > 0 && m_pParents[index] >= index)
+			return false;
+		if (node.ChildCount > 0 && (node.FirstChild <= index || node.FirstChild + node.ChildCount > nodeCount))
+			return false;
+
+		switch (node.Kind)
+		{
+		case FlatNodeKind::Conditional:
+			if (node.ChildCount > 0 || node.Payload >= ConditionCount())
+				return false;
+			m_Names.push_back(registry.GetCondition(m_pConditionIds[node.Payload]).Name);
+			break;
+		case FlatNodeKind::Action:
+		case FlatNodeKind::ActionInverse:
+			if (node.ChildCount > 0 || node.Payload >= ActionCount())
+				return false;
+			m_Names.push_back(registry.GetAction(m_pActionIds[node.Payload]).Name);
+			break;
+		case FlatNodeKind::PartialSequence:
+			if (node.Payload >= PartialCount())
+				return false;
+			m_Names.push_back(FlatBehaviorTree::KindName(node.Kind));
+			break;
+		default:
+			if (node.Kind > FlatNodeKind::ActionInverse)
+				return false;
+			m_Names.push_back(FlatBehaviorTree::KindName(node.Kind));
+			break;
+		}
+
+		//Leaves without a name fall back to the name of their kind, like NodeNames does
+		if (!m_Names.back())
+			m_Names.back() = FlatBehaviorTree::KindName(node.Kind);
+	}
+	return true;
+}
+
+void FlatTreeImage::Clear()
+{
+	if (m_pView)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pView);
+		CloseHandle(static_cast<HANDLE>(m_pMapping));
+		CloseHandle(static_cast<HANDLE>(m_pFile));
+#else
+		munmap(const_cast<void*>(m_pView), m_MappedSize);
+		close(static_cast<int>(reinterpret_cast<intptr_t>(m_pFile)));
+#endif
+	}
+
+	m_pView = nullptr;
+	m_MappedSize = 0;
+	m_pFile = nullptr;
+	m_pMapping = nullptr;
+	m_Buffer.clear();
+
+	m_pHeader = nullptr;
+	m_pEarlierWatches = nullptr;
+	m_pConditionInputs = nullptr;
+	m_pNodes = nullptr;
+	m_pParents = nullptr;
+	m_pConditionIds = nullptr;
+	m_pActionIds = nullptr;
+
+	m_Conditions.clear();
+	m_Actions.clear();
+	m_Names.clear();
+}
+#pragma endregion
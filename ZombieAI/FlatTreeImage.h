@@ -0,0 +1,161 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include "FlatBehaviorTree.h"
+
+#pragma region REGISTRY
+//Every condition and action a tree image can refer to
+//An image stores the index of a leaf in here instead of its function, those change with every build
+class FlatLeafRegistry final
+{
+public:
+	static const uint16_t InvalidLeaf = UINT16_MAX;
+
+	struct Condition
+	{
+		FlatConditionFn Function;
+		const char* Name;
+		BlackboardSlotMask Watches;
+		BlackboardSlotMask Inputs;
+	};
+	struct Action
+	{
+		FlatActionFn Function;
+		const char* Name;
+		BlackboardSlotMask Watches;
+	};
+
+	uint16_t Add(const Condition& condition);
+	uint16_t Add(const Action& action);
+	//Every leaf of the description that isn't in yet, with the name and entries the description gives it
+	void AddLeaves(const FlatTreeNode& root);
+
+	//InvalidLeaf when it isn't in
+	uint16_t FindCondition(FlatConditionFn function) const;
+	uint16_t FindAction(FlatActionFn function) const;
+
+	const Condition& GetCondition(uint16_t id) const { return m_Conditions[id]; }
+	const Action& GetAction(uint16_t id) const { return m_Actions[id]; }
+	size_t ConditionCount() const { return m_Conditions.size(); }
+	size_t ActionCount() const { return m_Actions.size(); }
+
+	//Changes whenever the names, order or entries of the leaves do, an image saved with another registry isn't loaded
+	uint32_t Hash() const;
+
+private:
+	vector<Condition> m_Conditions;
+	vector<Action> m_Actions;
+};
+#pragma endregion
+
+#pragma region IMAGE
+//Why a saved image couldn't be loaded
+enum class FlatTreeImageError : uint8_t
+{
+	None,
+	Missing,	//No file there, or it can't be opened
+	Unmappable,	//Opened but couldn't be mapped
+	NotAnImage,	//Too small, or another magic or version
+	OtherRegistry,	//Saved for other leaves
+	OtherSource,	//Saved from another description
+	Damaged,	//Checksum doesn't match, or an index is out of range
+};
+
+/*
+ * FLAT TREE IMAGE
+ * Everything about a compiled tree that never changes while it runs: its nodes, their parents and what their siblings watch
+ * One image is shared read-only by every agent running that tree, each FlatBehaviorTree only keeps its own running state
+ * Saved as one binary file laid out the way it's used, loading it maps the file instead of reading it
+ * Leaves are stored as their index in a FlatLeafRegistry, loading resolves them to the functions of this build
+ */
+class FlatTreeImage final
+{
+public:
+	FlatTreeImage() = default;
+	~FlatTreeImage();
+
+	FlatTreeImage(const FlatTreeImage&) = delete;
+	FlatTreeImage& operator=(const FlatTreeImage&) = delete;
+
+	//Compile the description, every leaf in it has to be in the registry
+	//The source hash goes into the file, loading checks it to tell whether the image still matches what it was built from
+	bool Build(const FlatTreeNode& root, const FlatLeafRegistry& registry, uint32_t sourceHash = 0);
+	//Map a saved image read-only, false when it's missing, damaged or was saved for another registry or source
+	//pError gets which of those it was
+	bool Load(const string& path, const FlatLeafRegistry& registry, uint32_t sourceHash = 0, FlatTreeImageError* pError = nullptr);
+	bool Save(const string& path) const;
+
+	bool IsValid() const { return m_pHeader != nullptr; }
+	bool IsMapped() const { return m_pView != nullptr; }
+
+	size_t NodeCount() const { return m_pHeader->NodeCount; }
+	size_t ConditionCount() const { return m_pHeader->ConditionCount; }
+	size_t ActionCount() const { return m_pHeader->ActionCount; }
+	size_t PartialCount() const { return m_pHeader->PartialCount; }
+
+	const FlatNode& GetNode(uint16_t index) const { return m_pNodes[index]; }
+	uint16_t GetParent(uint16_t index) const { return m_pParents[index]; }
+	//Entries watched by the siblings before the node
+	BlackboardSlotMask GetEarlierWatches(uint16_t index) const { return m_pEarlierWatches[index]; }
+	//Entries the condition reads, 0 when it isn't memoized
+	BlackboardSlotMask GetConditionInputs(uint16_t condition) const { return m_pConditionInputs[condition]; }
+	FlatConditionFn GetCondition(uint16_t condition) const { return m_Conditions[condition]; }
+	FlatActionFn GetAction(uint16_t action) const { return m_Actions[action]; }
+	const char* GetNodeName(uint16_t index) const { return m_Names[index]; }
+
+	//See FlatBehaviorTree::LayoutHash
+	uint32_t LayoutHash() const;
+	//What went wrong, to put in a log line
+	static const char* ErrorName(FlatTreeImageError error);
+	//Source hash for an image built from root, changes whenever the shape of the description or the names of its leaves do
+	static uint32_t DescriptionHash(const FlatTreeNode& root);
+
+private:
+	//Start of the file, the arrays follow from the widest to the narrowest so every one of them is aligned
+	struct FileHeader
+	{
+		static const uint32_t FileMagic = 0x31544246;	//"FBT1"
+		static const uint32_t FileVersion = 1;
+
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t RegistryHash;
+		uint32_t SourceHash;
+		uint32_t NodeCount;
+		uint32_t ConditionCount;
+		uint32_t ActionCount;
+		uint32_t PartialCount;
+		uint32_t Checksum;	//Of everything after the header
+		uint32_t Reserved;
+	};
+
+	static size_t ImageSize(size_t nodeCount, size_t conditionCount, size_t actionCount);
+	static uint32_t Checksum(const void* pData, size_t size);
+	//Points the arrays into an image at pData, false if it's too small for what the header says
+	bool SetView(const void* pData, size_t size);
+	//Checks every index in the image and looks up its leaves
+	bool Resolve(const FlatLeafRegistry& registry);
+	void Clear();
+
+	const FileHeader* m_pHeader = nullptr;
+	const BlackboardSlotMask* m_pEarlierWatches = nullptr;
+	const BlackboardSlotMask* m_pConditionInputs = nullptr;
+	const FlatNode* m_pNodes = nullptr;
+	const uint16_t* m_pParents = nullptr;
+	const uint16_t* m_pConditionIds = nullptr;
+	const uint16_t* m_pActionIds = nullptr;
+
+	//A built image lives here, a loaded one in the mapping
+	vector<uint64_t> m_Buffer;
+	const void* m_pView = nullptr;
+	size_t m_MappedSize = 0;
+	//Platform handles, the file and on Windows the mapping
+	void* m_pFile = nullptr;
+	void* m_pMapping = nullptr;
+
+	//Resolved for this build
+	vector<FlatConditionFn> m_Conditions;
+	vector<FlatActionFn> m_Actions;
+	vector<const char*> m_Names;
+};
+#pragma endregion
@@ -0,0 +1,181 @@
+#include "stdafx.h"
+#include "FlightRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "ZombieAgent.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+FlightRecorder::~FlightRecorder()
+{
+	Close();
+}
+
+bool FlightRecorder::Open(const string& path, uint32_t capacity, uint32_t treeLayout)
+{
+	Close();
+	if (capacity == 0)
+		return false;
+
+	const auto size = sizeof(FlightRecorderHeader) + static_cast<size_t>(capacity) * sizeof(FlightRecord);
+	void* pView = nullptr;
+
+#ifdef _WIN32
+	auto file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	auto mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), nullptr);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	pView = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+	if (!pView)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_pFile = file;
+	m_pMapping = mapping;
+#else
+	const auto file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+		return false;
+
+	if (ftruncate(file, static_cast<off_t>(size)) != 0)
+	{
+		close(file);
+		return false;
+	}
+
+	pView = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	if (pView == MAP_FAILED)
+	{
+		close(file);
+		return false;
+	}
+
+	m_pFile = reinterpret_cast<void*>(static_cast<intptr_t>(file));
+#endif
+
+	m_MappedSize = size;
+	m_pHeader = static_cast<FlightRecorderHeader*>(pView);
+	m_pRecords = reinterpret_cast<FlightRecord*>(m_pHeader + 1);
+
+	m_pHeader->Magic = FlightRecorderHeader::FileMagic;
+	m_pHeader->Version = FlightRecorderHeader::FileVersion;
+	m_pHeader->RecordSize = sizeof(FlightRecord);
+	m_pHeader->Capacity = capacity;
+	m_pHeader->TreeLayout = treeLayout;
+	m_pHeader->Padding = 0;
+	m_pHeader->RecordCount = 0;
+	return true;
+}
+
+void FlightRecorder::Close()
+{
+	if (!m_pHeader)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pHeader);
+	CloseHandle(static_cast<HANDLE>(m_pMapping));
+	CloseHandle(static_cast<HANDLE>(m_pFile));
+#else
+	munmap(m_pHeader, m_MappedSize);
+	close(static_cast<int>(reinterpret_cast<intptr_t>(m_pFile)));
+#endif
+
+	m_pHeader = nullptr;
+	m_pRecords = nullptr;
+	m_MappedSize = 0;
+	m_pFile = nullptr;
+	m_pMapping = nullptr;
+}
+
+void FlightRecorder::Write(const FlightRecord& record)
+{
+	if (!m_pHeader)
+		return;
+
+	const auto count = m_pHeader->RecordCount;
+	m_pRecords[count % m_pHeader->Capacity] = record;
+
+	//The record has to be in place before the count says it's there
+	std::atomic_thread_fence(std::memory_order_release);
+	m_pHeader->RecordCount = count + 1;
+}
+
+void FlightRecorder::Write(uint64_t frame, float time, float dt, const ZombieAgent& agent, const AgentInfo& agentInfo,
+	const b2Vec2& target, const SteeringBehaviours::ISteeringBehaviour* pBehaviour, const PluginOutput& output)
+{
+	if (!m_pHeader)
+		return;
+
+	const auto pBoard = agent.GetBlackboard();
+
+	FlightRecord record;
+	memset(&record, 0, sizeof(record));
+	record.Frame = frame;
+	record.Time = time;
+	record.Dt = dt;
+
+	record.Position[0] = agentInfo.Position.x;
+	record.Position[1] = agentInfo.Position.y;
+	record.Orientation = agentInfo.Orientation;
+	record.LinearVelocity[0] = agentInfo.LinearVelocity.x;
+	record.LinearVelocity[1] = agentInfo.LinearVelocity.y;
+	record.Health = agentInfo.Health;
+	record.Energy = agentInfo.Energy;
+	record.Stamina = agentInfo.Stamina;
+
+	record.Target[0] = target.x;
+	record.Target[1] = target.y;
+	if (const auto pTree = agent.GetFlatBehaviourTree())
+		record.PathLength = static_cast<uint8_t>(pTree->GetActivePath(record.Path, FlightRecord::MaxPathDepth));
+
+	//Which of the agent's behaviours it is
+	if (!pBehaviour)
+		record.Steering = FlightSteering::None;
+	else if (pBehaviour == pBoard->View(Keys::WanderBehaviour))
+		record.Steering = FlightSteering::Wander;
+	else if (pBehaviour == pBoard->View(Keys::SeekBehaviour))
+		record.Steering = FlightSteering::Seek;
+	else if (pBehaviour == pBoard->View(Keys::LookAroundBehaviour))
+		record.Steering = FlightSteering::LookAround;
+	else if (pBehaviour == pBoard->View(Keys::ArriveBehaviour))
+		record.Steering = FlightSteering::Arrive;
+	else
+		record.Steering = FlightSteering::Other;
+
+	record.EnemiesInView = static_cast<uint8_t>(std::min<size_t>(pBoard->View(Keys::Enemies).size(), UINT8_MAX));
+	record.KnownHouses = static_cast<uint16_t>(std::min<size_t>(pBoard->View(Keys::HouseLocations).Size(), UINT16_MAX));
+	record.KnownItems = static_cast<uint16_t>(std::min<size_t>(pBoard->View(Keys::Items).Size(), UINT16_MAX));
+
+	record.Flags = (agentInfo.RunMode ? FlightRunMode : 0)
+		| (agentInfo.Bitten ? FlightBitten : 0)
+		| (agentInfo.Death ? FlightDeath : 0)
+		| (output.RunMode ? FlightOutputRunMode : 0)
+		| (output.AutoOrientate ? FlightOutputAutoOrientate : 0);
+
+	record.OutputLinearVelocity[0] = output.LinearVelocity.x;
+	record.OutputLinearVelocity[1] = output.LinearVelocity.y;
+	record.OutputAngularVelocity = output.AngularVelocity;
+
+	Write(record);
+}
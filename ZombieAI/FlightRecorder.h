@@ -0,0 +1,121 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include "AI/SteeringBehaviours/SteeringBehaviours.h"
+
+class ZombieAgent;
+
+/*
+ * FLIGHT RECORDER
+ * One fixed-size binary record per frame, written into a memory-mapped ring file
+ * Writing a frame is a copy into mapped memory, the OS takes care of getting it to disk, even when the process crashes
+ * The record count in the header only moves on once a record is complete, so a reader never sees half a frame
+ * Tools/FlightRecorderReader decodes the file
+ */
+
+#pragma region RECORD
+//Steering behaviour the agent was using
+enum class FlightSteering : uint8_t
+{
+	None,
+	Wander,
+	Seek,
+	LookAround,
+	Arrive,
+	Other
+};
+
+//Bits in FlightRecord::Flags
+enum FlightRecordFlags : uint8_t
+{
+	FlightRunMode = 1 << 0,
+	FlightBitten = 1 << 1,
+	FlightDeath = 1 << 2,
+	FlightOutputRunMode = 1 << 3,
+	FlightOutputAutoOrientate = 1 << 4
+};
+
+//Everything about one frame, plain data with a fixed layout so the file reads back anywhere
+struct FlightRecord
+{
+	static const size_t MaxPathDepth = 24;
+
+	uint64_t Frame;
+	float Time;
+	float Dt;
+
+	//Agent
+	float Position[2];
+	float Orientation;
+	float LinearVelocity[2];
+	float Health;
+	float Energy;
+	float Stamina;
+
+	//Decision
+	float Target[2];
+	uint16_t Path[MaxPathDepth];	//Behaviour tree nodes from the root to the leaf the tick ended on
+	uint8_t PathLength;
+	FlightSteering Steering;
+
+	//Perception
+	uint8_t EnemiesInView;
+	uint8_t Flags;
+	uint16_t KnownHouses;
+	uint16_t KnownItems;
+
+	//What we sent to the framework
+	float OutputLinearVelocity[2];
+	float OutputAngularVelocity;
+	uint32_t Padding;
+};
+static_assert(sizeof(FlightRecord) == 128, "FlightRecord should stay two cache lines");
+
+//Start of the file, the records follow right after it
+struct FlightRecorderHeader
+{
+	static const uint32_t FileMagic = 0x3152465A;	//"ZFR1"
+	static const uint32_t FileVersion = 1;
+
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t RecordSize;
+	uint32_t Capacity;
+	uint32_t TreeLayout;	//FlatBehaviorTree::LayoutHash of the tree the paths are from
+	uint32_t Padding;
+	uint64_t RecordCount;	//Records written so far, the next one goes in slot RecordCount % Capacity
+};
+static_assert(sizeof(FlightRecorderHeader) == 32, "FlightRecorderHeader layout changed");
+#pragma endregion
+
+#pragma region RECORDER
+class FlightRecorder final
+{
+public:
+	FlightRecorder() = default;
+	~FlightRecorder();
+
+	FlightRecorder(const FlightRecorder&) = delete;
+	FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+	//Create the file with room for capacity records and map it, anything in it from an earlier run is lost
+	//Returns false if the file can't be created or mapped, writing does nothing then
+	bool Open(const string& path, uint32_t capacity, uint32_t treeLayout);
+	void Close();
+	bool IsOpen() const { return m_pHeader != nullptr; }
+
+	void Write(const FlightRecord& record);
+	//Fill a record from the agent and write it
+	void Write(uint64_t frame, float time, float dt, const ZombieAgent& agent, const AgentInfo& agentInfo,
+		const b2Vec2& target, const SteeringBehaviours::ISteeringBehaviour* pBehaviour, const PluginOutput& output);
+
+private:
+	FlightRecorderHeader* m_pHeader = nullptr;
+	FlightRecord* m_pRecords = nullptr;
+	size_t m_MappedSize = 0;
+
+	//Platform handles, the file and on Windows the mapping
+	void* m_pFile = nullptr;
+	void* m_pMapping = nullptr;
+};
+#pragma endregion
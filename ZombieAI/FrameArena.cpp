@@ -0,0 +1,51 @@
+#include "stdafx.h"
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+const size_t FrameArena::DefaultCapacity;
+
+FrameArena::FrameArena(size_t capacity)
+	: m_pBlock(static_cast<char*>(malloc(capacity)))
+	, m_Capacity(capacity)
+{
+	m_Overflow.reserve(16);
+}
+
+FrameArena::~FrameArena()
+{
+	Reset();
+	free(m_pBlock);
+}
+
+void FrameArena::Reset()
+{
+	m_Used = 0;
+	if (m_Overflow.empty())
+		return;
+
+	//Room for all of this frame and then some, the next one most likely needs about as much
+	const auto needed = m_Capacity + m_OverflowBytes;
+	for (auto pOverflow : m_Overflow)
+		free(pOverflow);
+	m_Overflow.clear();
+	m_OverflowBytes = 0;
+
+	free(m_pBlock);
+	m_Capacity = std::max(needed, 2 * m_Capacity);
+	m_pBlock = static_cast<char*>(malloc(m_Capacity));
+}
+
+void* FrameArena::AllocateOverflow(size_t size, size_t alignment)
+{
+	++m_Overflows;
+
+	//Over-allocated to line it up ourselves, malloc only promises the alignment of the largest type
+	const auto pOverflow = malloc(size + alignment);
+	m_Overflow.push_back(pOverflow);
+	m_OverflowBytes += size + alignment;
+
+	const auto address = (reinterpret_cast<uintptr_t>(pOverflow) + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	return reinterpret_cast<void*>(address);
+}
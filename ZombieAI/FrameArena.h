@@ -0,0 +1,127 @@
+#pragma once
+#include "stdafx.h"
+#include <cstddef>
+#include <cstdint>
+
+#pragma region defines
+//std::pmr only comes with C++17, older builds get the allocator alone
+#if (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || __cplusplus >= 201703L
+#include <memory_resource>
+#define FRAMEARENA_PMR 1
+#else
+#define FRAMEARENA_PMR 0
+#endif
+#pragma endregion
+
+class FrameArena;
+
+//Standard allocator handing out memory from a frame arena, deallocating does nothing
+template<typename T>
+class FrameAllocator
+{
+public:
+	using value_type = T;
+
+	explicit FrameAllocator(FrameArena* pArena) : m_pArena(pArena) {}
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>& other) : m_pArena(other.GetArena()) {}
+
+	T* allocate(size_t count);
+	void deallocate(T*, size_t) {}
+
+	FrameArena* GetArena() const { return m_pArena; }
+
+	template<typename U>
+	bool operator==(const FrameAllocator<U>& other) const { return m_pArena == other.GetArena(); }
+	template<typename U>
+	bool operator!=(const FrameAllocator<U>& other) const { return m_pArena != other.GetArena(); }
+
+private:
+	FrameArena* m_pArena;
+};
+
+//Vector that only lives for the frame
+template<typename T>
+using FrameVector = vector<T, FrameAllocator<T>>;
+
+/*
+ * FRAME ARENA
+ * Memory for whatever is dead by the end of the frame, handed out by bumping an offset into one block
+ * Nothing is freed on its own, Reset takes it all back at once
+ * A frame that needs more than the block gets it from the heap, the next Reset grows the block so the frame after fits
+ * Not thread safe, every agent has its own
+ */
+class FrameArena final
+{
+public:
+	static const size_t DefaultCapacity = 16 * 1024;
+
+	explicit FrameArena(size_t capacity = DefaultCapacity);
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment)
+	{
+		const auto base = reinterpret_cast<uintptr_t>(m_pBlock);
+		const auto address = (base + m_Used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+		if (address + size > base + m_Capacity)
+			return AllocateOverflow(size, alignment);
+
+		m_Used = address + size - base;
+		return reinterpret_cast<void*>(address);
+	}
+
+	//Everything allocated since the last reset is gone, only touches the heap after a frame that didn't fit
+	void Reset();
+
+	template<typename T>
+	FrameVector<T> Vector() { return FrameVector<T>(FrameAllocator<T>(this)); }
+
+#if FRAMEARENA_PMR
+	//For std::pmr containers
+	std::pmr::memory_resource* GetResource() { return &m_Resource; }
+#endif
+
+	size_t Capacity() const { return m_Capacity; }
+	size_t Used() const { return m_Used + m_OverflowBytes; }
+	uint64_t GetOverflows() const { return m_Overflows; }	//Allocations that went to the heap, since it was made
+
+private:
+#if FRAMEARENA_PMR
+	class Resource final : public std::pmr::memory_resource
+	{
+	public:
+		explicit Resource(FrameArena* pArena) : m_pArena(pArena) {}
+
+	private:
+		void* do_allocate(size_t size, size_t alignment) override { return m_pArena->Allocate(size, alignment); }
+		void do_deallocate(void*, size_t, size_t) override {}
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+		FrameArena* m_pArena;
+	};
+#endif
+
+	void* AllocateOverflow(size_t size, size_t alignment);
+
+	char* m_pBlock = nullptr;
+	size_t m_Capacity = 0;
+	size_t m_Used = 0;
+
+	//Heap allocations of this frame, freed by the next reset
+	vector<void*> m_Overflow;
+	size_t m_OverflowBytes = 0;
+	uint64_t m_Overflows = 0;
+
+#if FRAMEARENA_PMR
+	Resource m_Resource{ this };
+#endif
+};
+
+template<typename T>
+T* FrameAllocator<T>::allocate(size_t count)
+{
+	return static_cast<T*>(m_pArena->Allocate(count * sizeof(T), alignof(T)));
+}
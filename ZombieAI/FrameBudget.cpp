@@ -0,0 +1,88 @@
+#include "stdafx.h"
+#include "FrameBudget.h"
+
+#include <algorithm>
+
+void FrameBudgetScheduler::Resize(size_t count)
+{
+	m_Agents.resize(count);
+}
+
+void FrameBudgetScheduler::Clear()
+{
+	m_Agents.clear();
+	m_Candidates.clear();
+	m_Ticked = 0;
+	m_Starved = 0;
+	m_TickCost = 0.0;
+}
+
+void FrameBudgetScheduler::Plan(const vector<AgentLod>& lods, vector<uint8_t>& ticked)
+{
+	ticked.assign(m_Agents.size(), 0);
+	m_Candidates.clear();
+	const auto unlimited = m_Settings.Budget <= 0.0 || m_TickCost <= 0.0;
+
+	//Whoever can't wait is ticked first
+	size_t mustTick = 0;
+	for (size_t i = 0; i < m_Agents.size(); ++i)
+	{
+		auto& agent = m_Agents[i];
+		++agent.Wait;
+
+		if (unlimited || lods[i] == AgentLod::Critical)
+		{
+			ticked[i] = 1;
+			++mustTick;
+		}
+		else if (agent.Wait > MaxWait(lods[i]))
+		{
+			++agent.Starved;
+			++m_Starved;
+			ticked[i] = 1;
+			++mustTick;
+		}
+		else
+		{
+			m_Candidates.push_back(static_cast<uint32_t>(i));
+		}
+	}
+
+	//What's left of the budget goes to whoever used up the most of the wait their lod allows, the lowest index on a tie
+	const auto left = unlimited ? 0.0 : m_Settings.Budget - mustTick * m_TickCost;
+	const auto fit = std::min(m_Candidates.size(), left > 0.0 ? static_cast<size_t>(left / m_TickCost) : size_t(0));
+	if (fit > 0)
+	{
+		auto moreUrgent = [this, &lods](uint32_t a, uint32_t b)
+		{
+			//Wait over MaxWait without dividing
+			const auto urgencyA = static_cast<uint64_t>(m_Agents[a].Wait) * MaxWait(lods[b]);
+			const auto urgencyB = static_cast<uint64_t>(m_Agents[b].Wait) * MaxWait(lods[a]);
+			return urgencyA != urgencyB ? urgencyA > urgencyB : a < b;
+		};
+		std::nth_element(m_Candidates.begin(), m_Candidates.begin() + (fit - 1), m_Candidates.end(), moreUrgent);
+		for (size_t c = 0; c < fit; ++c)
+			ticked[m_Candidates[c]] = 1;
+	}
+
+	m_Ticked = mustTick + fit;
+	for (size_t i = 0; i < m_Agents.size(); ++i)
+	{
+		auto& agent = m_Agents[i];
+		agent.TickRate += TickRateSmoothing * ((ticked[i] ? 1.f : 0.f) - agent.TickRate);
+		if (!ticked[i])
+			continue;
+
+		++agent.Ticks;
+		agent.Wait = 0;
+	}
+}
+
+void FrameBudgetScheduler::Finish(double seconds)
+{
+	if (m_Ticked == 0)
+		return;
+
+	const auto cost = seconds / m_Ticked;
+	m_TickCost = m_TickCost <= 0.0 ? cost : m_TickCost + TickCostSmoothing * (cost - m_TickCost);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+
+//How much an agent needs its behaviour tree and steering this frame
+enum class AgentLod : uint8_t
+{
+	Critical,	//Bitten or an enemy close by, ticked every frame whatever the budget
+	Active,	//Enemies or items in view
+	Idle	//Nothing around, just walking somewhere
+};
+
+struct FrameBudgetSettings
+{
+	double Budget = 0.0;	//Seconds the tree and steering of every agent together may take each frame, 0 ticks every agent every frame
+	//Most frames from one tick of an agent to the next, one more and it's starved and ticked whatever the budget
+	uint32_t MaxActiveWait = 3;
+	uint32_t MaxIdleWait = 15;
+};
+
+struct AgentTickStats
+{
+	uint64_t Ticks = 0;
+	uint64_t Starved = 0;	//Frames it waited longer than its lod allows
+	uint32_t Wait = 0;	//Frames since its last tick
+	float TickRate = 0.f;	//Ticks per frame, averaged over the last few dozen frames
+};
+
+/*
+ * FRAME BUDGET
+ * Decides which agents get their behaviour tree and steering this frame, so all of them together stay within a time budget
+ * Critical agents are always ticked, the others take turns by how long they waited compared to how long their lod lets them wait
+ * The rest reuse the output of their last tick
+ * How many fit in depends on how long ticks took on the frames before, so a run with a budget isn't reproducible
+ */
+class FrameBudgetScheduler final
+{
+public:
+	void SetSettings(const FrameBudgetSettings& settings) { m_Settings = settings; }
+	const FrameBudgetSettings& GetSettings() const { return m_Settings; }
+
+	void Resize(size_t count);
+	void Clear();
+
+	//Sets ticked for every agent that gets its tick this frame
+	void Plan(const vector<AgentLod>& lods, vector<uint8_t>& ticked);
+	//How long the ticks of this frame took, their cost is what the next frame plans with
+	void Finish(double seconds);
+
+	const AgentTickStats& GetAgentStats(size_t index) const { return m_Agents[index]; }
+	//Ticks per second for a frame time of dt
+	float GetTickRate(size_t index, float dt) const { return dt > 0.f ? m_Agents[index].TickRate / dt : 0.f; }
+
+	size_t GetTicked() const { return m_Ticked; }
+	size_t GetDeferred() const { return m_Agents.size() - m_Ticked; }
+	uint64_t GetStarved() const { return m_Starved; }	//Of every agent together
+	double GetTickCost() const { return m_TickCost; }	//Seconds per tick, averaged
+
+private:
+	//Weight of the newest frame in the averages
+	static constexpr float TickRateSmoothing = 0.05f;
+	static constexpr double TickCostSmoothing = 0.1;
+
+	uint32_t MaxWait(AgentLod lod) const { return lod == AgentLod::Active ? m_Settings.MaxActiveWait : m_Settings.MaxIdleWait; }
+
+	FrameBudgetSettings m_Settings;
+	vector<AgentTickStats> m_Agents;
+	vector<uint32_t> m_Candidates;	//Agents that may wait, most urgent first once sorted
+	size_t m_Ticked = 0;
+	uint64_t m_Starved = 0;
+	double m_TickCost = 0.0;	//0 until the first frame with ticks was measured, everything is ticked until then
+};
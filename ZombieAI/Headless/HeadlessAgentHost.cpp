@@ -0,0 +1,363 @@
+#include "stdafx.h"
+#include "HeadlessAgentHost.h"
+
+#include <algorithm>
+
+namespace
+{
+	const float Pi = 3.14159265f;
+}
+
+HeadlessAgentHost::HeadlessAgentHost(const HeadlessWorld* pWorld, uint32_t seed, PathService* pPathService)
+	: m_pWorld(pWorld)
+	, m_Random(seed)
+	, m_AgentInfo()
+	, m_PathCache(&pWorld->GetNavMesh(), pWorld->GetHierarchy(), pPathService)
+{
+	const auto& settings = m_pWorld->GetSettings();
+	const auto& navMesh = m_pWorld->GetNavMesh();
+
+	//Start in the street closest to the center of the world
+	m_AgentInfo.Health = settings.MaxHealth;
+	m_AgentInfo.Energy = settings.MaxEnergy;
+	m_AgentInfo.Stamina = settings.MaxStamina;
+	m_AgentInfo.GrabRange = 2.f;
+	m_AgentInfo.FOV_Angle = Pi / 2.f;
+	m_AgentInfo.FOV_Range = 20.f;
+	m_AgentInfo.MaxLinearSpeed = settings.WalkSpeed;
+	m_AgentInfo.MaxAngularSpeed = Pi;
+	m_AgentInfo.AgentSize = 1.f;
+	m_AgentInfo.Position = navMesh.GetCenter(navMesh.GetClosestWalkable(m_pWorld->GetWorldInfo().Center));
+
+	//Items in the houses
+	const auto itemCount = settings.ItemsPerHouse * static_cast<int>(m_pWorld->GetHouses().size());
+	for (int i = 0; i < itemCount; ++i)
+		SpawnItem();
+
+	//Enemies roam the streets, but not right on top of us
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	const auto& dimensions = m_pWorld->GetWorldInfo().Dimensions;
+	while (static_cast<int>(m_Enemies.size()) < settings.EnemyCount)
+	{
+		Enemy enemy;
+		enemy.Position = b2Vec2((unit(m_Random) - 0.5f) * dimensions.x, (unit(m_Random) - 0.5f) * dimensions.y);
+		const auto angle = unit(m_Random) * 2.f * Pi;
+		enemy.Direction = b2Vec2(cos(angle), sin(angle));
+
+		if (!navMesh.IsWalkable(navMesh.GetPolygon(enemy.Position)))
+			continue;
+		if ((enemy.Position - m_AgentInfo.Position).Length() < settings.EnemySightRange * 2.f)
+			continue;
+
+		m_Enemies.push_back(enemy);
+	}
+}
+
+void HeadlessAgentHost::Step(float dt, const PluginOutput& output)
+{
+	if (m_AgentInfo.Death)
+		return;
+
+	const auto& settings = m_pWorld->GetSettings();
+
+	MoveAgent(dt, output);
+	MoveEnemies(dt);
+
+	//Enemies bite when they're close enough, once in a while
+	m_AgentInfo.Bitten = false;
+	m_BiteCooldown = std::max(m_BiteCooldown - dt, 0.f);
+	for (const auto& enemy : m_Enemies)
+	{
+		if (m_BiteCooldown > 0.f || (enemy.Position - m_AgentInfo.Position).Length() > settings.BiteRange)
+			continue;
+
+		m_AgentInfo.Health -= 1.f;
+		m_AgentInfo.Bitten = true;
+		m_BiteCooldown = settings.BiteCooldown;
+	}
+
+	//Hunger
+	m_AgentInfo.Energy -= settings.EnergyDrainPerSecond * dt;
+
+	m_SurvivalTime += dt;
+	if (m_AgentInfo.Health <= 0.f || m_AgentInfo.Energy <= 0.f)
+		m_AgentInfo.Death = true;
+}
+
+#pragma region Perception
+vector<HouseInfo> HeadlessAgentHost::FOV_GetHouses()
+{
+	vector<HouseInfo> houses;
+	CollectHouses(houses);
+	return houses;
+}
+
+vector<EntityInfo> HeadlessAgentHost::FOV_GetEntities()
+{
+	vector<EntityInfo> entities;
+	CollectEntities(entities);
+	return entities;
+}
+
+void HeadlessAgentHost::FOV_FillHouses(FrameVector<HouseInfo>& houses)
+{
+	CollectHouses(houses);
+}
+
+void HeadlessAgentHost::FOV_FillEntities(FrameVector<EntityInfo>& entities)
+{
+	CollectEntities(entities);
+}
+
+template<typename Container>
+void HeadlessAgentHost::CollectHouses(Container& houses) const
+{
+	//Houses are big, we see them as soon as any part of them is in range
+	for (const auto& house : m_pWorld->GetHouses())
+	{
+		const auto delta = b2Abs(house.Center - m_AgentInfo.Position) - 0.5f * house.Size;
+		const auto outside = b2Vec2(std::max(delta.x, 0.f), std::max(delta.y, 0.f));
+		if (outside.Length() <= m_AgentInfo.FOV_Range)
+			houses.push_back(house);
+	}
+}
+
+template<typename Container>
+void HeadlessAgentHost::CollectEntities(Container& entities) const
+{
+	for (const auto& item : m_Items)
+	{
+		if (IsInView(item.Entity.Position))
+			entities.push_back(item.Entity);
+	}
+
+	for (size_t i = 0; i < m_Enemies.size(); ++i)
+	{
+		if (!IsInView(m_Enemies[i].Position))
+			continue;
+
+		EntityInfo entity = {};
+		entity.Type = ENEMY;
+		entity.Position = m_Enemies[i].Position;
+		entity.EntityHash = -static_cast<int>(i) - 1;
+		entities.push_back(entity);
+	}
+}
+
+bool HeadlessAgentHost::IsInView(const b2Vec2& position) const
+{
+	const auto delta = position - m_AgentInfo.Position;
+	const auto distance = delta.Length();
+	if (distance > m_AgentInfo.FOV_Range)
+		return false;
+	if (distance <= m_AgentInfo.AgentSize)
+		return true;
+
+	//Inside the view cone
+	const auto facing = b2Vec2(cos(m_AgentInfo.Orientation), sin(m_AgentInfo.Orientation));
+	return b2Dot(facing, delta) / distance >= cos(m_AgentInfo.FOV_Angle / 2.f);
+}
+#pragma endregion
+
+#pragma region Inventory
+bool HeadlessAgentHost::INVENTORY_GetItem(int slot, ItemInfo& item)
+{
+	if (!IsValidSlot(slot) || !m_SlotUsed[slot])
+		return false;
+
+	item = m_Inventory[slot];
+	return true;
+}
+
+bool HeadlessAgentHost::INVENTORY_AddItem(int slot, ItemInfo item)
+{
+	if (!IsValidSlot(slot) || m_SlotUsed[slot])
+		return false;
+
+	m_Inventory[slot] = item;
+	m_SlotUsed[slot] = true;
+	return true;
+}
+
+bool HeadlessAgentHost::INVENTORY_UseItem(int slot)
+{
+	if (!IsValidSlot(slot) || !m_SlotUsed[slot])
+		return false;
+
+	const auto& settings = m_pWorld->GetSettings();
+	auto& amount = m_ItemAmounts[m_Inventory[slot].ItemHash];
+
+	switch (m_Inventory[slot].Type)
+	{
+	case HEALTH:
+		m_AgentInfo.Health = std::min(m_AgentInfo.Health + amount, settings.MaxHealth);
+		break;
+	case FOOD:
+		m_AgentInfo.Energy = std::min(m_AgentInfo.Energy + amount, settings.MaxEnergy);
+		break;
+	default:
+		return false;
+	}
+
+	//Used up
+	amount = 0;
+	return true;
+}
+
+bool HeadlessAgentHost::INVENTORY_RemoveItem(int slot)
+{
+	if (!IsValidSlot(slot) || !m_SlotUsed[slot])
+		return false;
+
+	m_ItemAmounts.erase(m_Inventory[slot].ItemHash);
+	m_SlotUsed[slot] = false;
+	return true;
+}
+#pragma endregion
+
+#pragma region Items
+bool HeadlessAgentHost::ITEM_Grab(EntityInfo entity, ItemInfo& item)
+{
+	auto it = std::find_if(m_Items.begin(), m_Items.end(), [&](const WorldItem& worldItem)
+	{
+		return worldItem.Entity.EntityHash == entity.EntityHash;
+	});
+
+	if (it == m_Items.end())
+		return false;
+	if ((it->Entity.Position - m_AgentInfo.Position).Length() > m_AgentInfo.GrabRange)
+		return false;
+
+	item = it->Item;
+	*it = m_Items.back();
+	m_Items.pop_back();
+
+	//Something else turns up somewhere else
+	SpawnItem();
+	return true;
+}
+
+bool HeadlessAgentHost::ITEM_GetMetadata(ItemInfo item, const string& field, int& value)
+{
+	const auto it = m_ItemAmounts.find(item.ItemHash);
+	if (it == m_ItemAmounts.end())
+		return false;
+
+	if ((item.Type == HEALTH && field == "health") || (item.Type == FOOD && field == "energy"))
+	{
+		value = it->second;
+		return true;
+	}
+	return false;
+}
+
+void HeadlessAgentHost::SpawnItem()
+{
+	const auto& houses = m_pWorld->GetHouses();
+	if (houses.empty())
+		return;
+
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	const auto& house = houses[std::uniform_int_distribution<size_t>(0, houses.size() - 1)(m_Random)];
+
+	//Somewhere inside, away from the walls
+	const auto inner = house.Size - b2Vec2(4.f, 4.f);
+	const auto position = house.Center + b2Vec2((unit(m_Random) - 0.5f) * inner.x, (unit(m_Random) - 0.5f) * inner.y);
+
+	//Mostly things we want, some things we don't
+	const auto roll = unit(m_Random);
+	const auto type = roll < 0.3f ? HEALTH : roll < 0.7f ? FOOD : roll < 0.85f ? PISTOL : GARBAGE;
+
+	WorldItem worldItem;
+	worldItem.Entity = {};
+	worldItem.Entity.Type = ITEM;
+	worldItem.Entity.Position = position;
+	worldItem.Entity.EntityHash = m_NextHash;
+	worldItem.Item = {};
+	worldItem.Item.Type = type;
+	worldItem.Item.ItemHash = m_NextHash;
+	++m_NextHash;
+
+	if (type == HEALTH)
+		m_ItemAmounts[worldItem.Item.ItemHash] = std::uniform_int_distribution<int>(1, 5)(m_Random);
+	else if (type == FOOD)
+		m_ItemAmounts[worldItem.Item.ItemHash] = std::uniform_int_distribution<int>(2, 8)(m_Random);
+
+	m_Items.push_back(worldItem);
+}
+#pragma endregion
+
+#pragma region Movement
+b2Vec2 HeadlessAgentHost::NAVMESH_GetClosestPathPoint(b2Vec2 goal)
+{
+	if (m_pWorld->GetSettings().PathCache)
+		return m_PathCache.GetClosestPathPoint(m_AgentInfo.Position, goal);
+
+	return m_pWorld->GetNavMesh().GetClosestPathPoint(m_AgentInfo.Position, goal);
+}
+
+void HeadlessAgentHost::MoveAgent(float dt, const PluginOutput& output)
+{
+	const auto& settings = m_pWorld->GetSettings();
+	const auto& navMesh = m_pWorld->GetNavMesh();
+
+	//Running costs stamina, walking gives it back
+	const auto running = output.RunMode && m_AgentInfo.Stamina > 0.f;
+	m_AgentInfo.Stamina = std::min(std::max(m_AgentInfo.Stamina + (running ? -1.f : 0.5f) * dt, 0.f), settings.MaxStamina);
+	m_AgentInfo.RunMode = running;
+	m_AgentInfo.MaxLinearSpeed = running ? settings.RunSpeed : settings.WalkSpeed;
+
+	auto velocity = output.LinearVelocity;
+	const auto speed = velocity.Length();
+	if (speed > m_AgentInfo.MaxLinearSpeed)
+		velocity *= m_AgentInfo.MaxLinearSpeed / speed;
+
+	//Walls stop us, slide along them if we can
+	const auto step = dt * velocity;
+	const b2Vec2 candidates[] = { step, b2Vec2(step.x, 0.f), b2Vec2(0.f, step.y) };
+	for (const auto& candidate : candidates)
+	{
+		if (navMesh.IsWalkable(navMesh.GetPolygon(m_AgentInfo.Position + candidate)))
+		{
+			m_AgentInfo.Position += candidate;
+			break;
+		}
+	}
+
+	m_AgentInfo.LinearVelocity = velocity;
+	m_AgentInfo.CurrentLinearSpeed = velocity.Length();
+
+	if (output.AutoOrientate && m_AgentInfo.CurrentLinearSpeed > 0.f)
+		m_AgentInfo.Orientation = atan2(velocity.y, velocity.x);
+	else
+		m_AgentInfo.Orientation += std::min(std::max(output.AngularVelocity, -m_AgentInfo.MaxAngularSpeed), m_AgentInfo.MaxAngularSpeed) * dt;
+	m_AgentInfo.AngularVelocity = output.AngularVelocity;
+}
+
+void HeadlessAgentHost::MoveEnemies(float dt)
+{
+	const auto& settings = m_pWorld->GetSettings();
+	const auto& navMesh = m_pWorld->GetNavMesh();
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+	for (auto& enemy : m_Enemies)
+	{
+		//Go for the agent when it's close, otherwise shamble around
+		const auto toAgent = m_AgentInfo.Position - enemy.Position;
+		const auto distance = toAgent.Length();
+		if (distance < settings.EnemySightRange && distance > 0.f)
+			enemy.Direction = (1.f / distance) * toAgent;
+		else if (unit(m_Random) < dt * 0.2f)
+		{
+			const auto angle = unit(m_Random) * 2.f * Pi;
+			enemy.Direction = b2Vec2(cos(angle), sin(angle));
+		}
+
+		const auto position = enemy.Position + (settings.EnemySpeed * dt) * enemy.Direction;
+		if (navMesh.IsWalkable(navMesh.GetPolygon(position)))
+			enemy.Position = position;
+		else
+			enemy.Direction = -enemy.Direction;
+	}
+}
+#pragma endregion
@@ -0,0 +1,89 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include "AI/BehaviourTree/AgentHost.h"
+#include "HeadlessWorld.h"
+#include "PathCache.h"
+
+/*
+ * HEADLESS AGENT HOST
+ * One game for one agent in a shared headless world
+ * The houses and the navmesh come from the world, the items, enemies and inventory are this agent's own
+ * Nothing is shared between hosts, so every agent plays the same game whatever the others do or whichever thread runs it
+ */
+class HeadlessAgentHost final : public IAgentHost
+{
+public:
+	//Paths are planned in the frame that asks for them without a path service
+	HeadlessAgentHost(const HeadlessWorld* pWorld, uint32_t seed, PathService* pPathService = nullptr);
+
+	//Move the agent with its steering, then let the world react
+	void Step(float dt, const PluginOutput& output);
+
+	bool IsDead() const { return m_AgentInfo.Death; }
+	float GetSurvivalTime() const { return m_SurvivalTime; }
+	const PathCacheStats& GetPathCacheStats() const { return m_PathCache.GetStats(); }
+
+	AgentInfo AGENT_GetInfo() override { return m_AgentInfo; }
+	WorldInfo WORLD_GetInfo() override { return m_pWorld->GetWorldInfo(); }
+
+	vector<HouseInfo> FOV_GetHouses() override;
+	vector<EntityInfo> FOV_GetEntities() override;
+	void FOV_FillHouses(FrameVector<HouseInfo>& houses) override;
+	void FOV_FillEntities(FrameVector<EntityInfo>& entities) override;
+
+	int INVENTORY_GetCapacity() override { return InventoryCapacity; }
+	bool INVENTORY_GetItem(int slot, ItemInfo& item) override;
+	bool INVENTORY_AddItem(int slot, ItemInfo item) override;
+	bool INVENTORY_UseItem(int slot) override;
+	bool INVENTORY_RemoveItem(int slot) override;
+
+	bool ITEM_Grab(EntityInfo entity, ItemInfo& item) override;
+	bool ITEM_GetMetadata(ItemInfo item, const string& field, int& value) override;
+
+	b2Vec2 NAVMESH_GetClosestPathPoint(b2Vec2 goal) override;
+
+private:
+	static const int InventoryCapacity = 5;
+
+	struct WorldItem
+	{
+		EntityInfo Entity;
+		ItemInfo Item;
+	};
+	struct Enemy
+	{
+		b2Vec2 Position;
+		b2Vec2 Direction;
+	};
+
+	//Whatever is in view added to any vector of houses or entities
+	template<typename Container>
+	void CollectHouses(Container& houses) const;
+	template<typename Container>
+	void CollectEntities(Container& entities) const;
+
+	void SpawnItem();
+	void MoveAgent(float dt, const PluginOutput& output);
+	void MoveEnemies(float dt);
+	bool IsInView(const b2Vec2& position) const;
+	bool IsValidSlot(int slot) const { return slot >= 0 && slot < InventoryCapacity; }
+
+	const HeadlessWorld* m_pWorld;
+	std::mt19937 m_Random;
+	int m_NextHash = 1;
+
+	AgentInfo m_AgentInfo;
+	PathCache m_PathCache;
+	float m_SurvivalTime = 0.f;
+	float m_BiteCooldown = 0.f;
+
+	vector<WorldItem> m_Items;
+	vector<Enemy> m_Enemies;
+	std::unordered_map<int, int> m_ItemAmounts;	//Health or energy of every item, by hash
+
+	ItemInfo m_Inventory[InventoryCapacity];
+	bool m_SlotUsed[InventoryCapacity] = {};
+};
@@ -0,0 +1,137 @@
+#include "stdafx.h"
+#include "HeadlessRunner.h"
+#include "AI/BehaviourTree/ZombieBehaviourTree.h"
+
+#include <algorithm>
+#include <chrono>
+
+HeadlessRunner::HeadlessRunner(const HeadlessRunSettings& settings)
+	: m_Settings(settings)
+{
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+	End();
+}
+
+void HeadlessRunner::Start()
+{
+	End();
+	m_Stats = HeadlessRunStats();
+
+	m_pWorld = new HeadlessWorld(m_Settings.World);
+	if (m_Settings.ThreadCount != 1)
+		m_pScheduler = new TaskScheduler(m_Settings.ThreadCount);
+	if (m_Settings.PathThreads > 0)
+		m_pPathService = new PathService(&m_pWorld->GetNavMesh(), m_pWorld->GetHierarchy(), m_Settings.PathThreads);
+
+	//Before the first agent starts, or they'd run the image built in memory
+	if (!m_Settings.TreeImageFile.empty())
+		m_Stats.TreeImage = LoadZombieTreeImage(m_Settings.TreeImageFile, &m_Stats.TreeImageError);
+
+	m_pPopulation = new AgentPopulation(m_pWorld->GetWorldInfo());
+	m_pPopulation->SetScheduler(m_pScheduler);
+	m_pPopulation->SetBatchSteering(m_Settings.BatchSteering);
+	m_pPopulation->SetFrameBudget(m_Settings.FrameBudget);
+
+	//Every agent gets a game of its own, seeded by its index
+	for (size_t i = 0; i < m_Settings.AgentCount; ++i)
+	{
+		auto pHost = new HeadlessAgentHost(m_pWorld, m_Settings.World.Seed + static_cast<uint32_t>(i), m_pPathService);
+		m_Hosts.push_back(pHost);
+		m_pPopulation->Add(pHost);
+	}
+}
+
+bool HeadlessRunner::Update()
+{
+	if (!m_pPopulation || m_Stats.SimulatedSeconds >= m_Settings.Duration || m_Stats.Deaths == m_Hosts.size())
+		return false;
+
+	const auto dt = m_Settings.TimeStep;
+	const auto frameStart = std::chrono::steady_clock::now();
+	m_pPopulation->Update(dt, m_Outputs);
+	m_FrameSeconds.push_back(std::chrono::duration<float>(std::chrono::steady_clock::now() - frameStart).count());
+
+	//Let every world react to its agent
+	auto step = [this, dt](size_t begin, size_t end)
+	{
+		for (auto i = begin; i < end; ++i)
+			m_Hosts[i]->Step(dt, m_Outputs[i]);
+	};
+	if (m_pScheduler)
+		m_pScheduler->ParallelFor(m_Hosts.size(), 16, step);
+	else
+		step(0, m_Hosts.size());
+
+	m_Stats.SimulatedSeconds += dt;
+	++m_Stats.Frames;
+	UpdateStats();
+
+	return m_Stats.SimulatedSeconds < m_Settings.Duration && m_Stats.Deaths < m_Hosts.size();
+}
+
+void HeadlessRunner::End()
+{
+	//The agents go before the hosts they live in
+	delete m_pPopulation;
+	m_pPopulation = nullptr;
+	for (auto pHost : m_Hosts)
+		delete pHost;
+	m_Hosts.clear();
+	m_Outputs.clear();
+	m_FrameSeconds.clear();
+
+	//After the hosts cancelled what they still wanted, before the navmesh it searches on
+	delete m_pPathService;
+	m_pPathService = nullptr;
+	delete m_pScheduler;
+	m_pScheduler = nullptr;
+	delete m_pWorld;
+	m_pWorld = nullptr;
+}
+
+HeadlessRunStats HeadlessRunner::Run()
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	Start();
+	while (Update())
+		;
+
+	m_Stats.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (!m_FrameSeconds.empty())
+	{
+		double total = 0.0;
+		for (auto seconds : m_FrameSeconds)
+			total += seconds;
+		m_Stats.AverageFrameSeconds = total / m_FrameSeconds.size();
+
+		const auto p99 = m_FrameSeconds.begin() + (m_FrameSeconds.size() - 1) * 99 / 100;
+		std::nth_element(m_FrameSeconds.begin(), p99, m_FrameSeconds.end());
+		m_Stats.P99FrameSeconds = *p99;
+	}
+	const auto stats = m_Stats;
+	End();
+	return stats;
+}
+
+void HeadlessRunner::UpdateStats()
+{
+	m_Stats.Deaths = 0;
+	m_Stats.PathCache = PathCacheStats();
+	m_Stats.Ticks = 0;
+	m_Stats.Starved = m_pPopulation->GetFrameBudget().GetStarved();
+	auto survival = 0.f;
+	for (size_t i = 0; i < m_Hosts.size(); ++i)
+	{
+		const auto pHost = m_Hosts[i];
+		m_Stats.Ticks += m_pPopulation->GetFrameBudget().GetAgentStats(i).Ticks;
+		if (pHost->IsDead())
+			++m_Stats.Deaths;
+		survival += pHost->GetSurvivalTime();
+		m_Stats.PathCache += pHost->GetPathCacheStats();
+	}
+	m_Stats.AverageSurvival = m_Hosts.empty() ? 0.f : survival / m_Hosts.size();
+}
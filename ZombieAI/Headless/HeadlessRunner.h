@@ -0,0 +1,81 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include "AI/BehaviourTree/AgentPopulation.h"
+#include "AI/BehaviourTree/TaskScheduler.h"
+#include "AI/BehaviourTree/ZombieBehaviourTree.h"
+#include "AI/BehaviourTree/FlatTreeImage.h"
+#include "HeadlessWorld.h"
+#include "HeadlessAgentHost.h"
+#include "PathService.h"
+
+struct HeadlessRunSettings
+{
+	size_t AgentCount = 1;
+	size_t ThreadCount = 1;	//1 runs everything on the calling thread, 0 picks one per core
+	float TimeStep = 1.f / 60.f;
+	float Duration = 60.f;	//Simulated seconds, the run stops earlier when every agent died
+	bool BatchSteering = false;	//See AgentPopulation::SetBatchSteering
+	FrameBudgetSettings FrameBudget;	//See AgentPopulation::SetFrameBudget, a run with a budget isn't reproducible
+	size_t PathThreads = 0;	//Workers of a PathService that plans paths in the background, 0 plans them in the frame that asks, a run with it isn't reproducible
+	string TreeImageFile;	//Compiled behaviour tree the agents share, mapped when it's up to date, saved there when it isn't
+	HeadlessWorldSettings World;
+};
+
+struct HeadlessRunStats
+{
+	double SimulatedSeconds = 0.0;
+	double WallSeconds = 0.0;
+	uint64_t Frames = 0;
+	size_t Deaths = 0;
+	float AverageSurvival = 0.f;
+	PathCacheStats PathCache;	//Of every agent together
+	double AverageFrameSeconds = 0.0;	//Wall time of the population update alone
+	double P99FrameSeconds = 0.0;
+	uint64_t Ticks = 0;	//Behaviour tree ticks of every agent together
+	uint64_t Starved = 0;	//See FrameBudgetScheduler::GetStarved
+	ZombieTreeImageStatus TreeImage = ZombieTreeImageStatus::Mapped;	//Only when there's a TreeImageFile
+	FlatTreeImageError TreeImageError = FlatTreeImageError::None;	//Why the saved image wasn't mapped
+};
+
+/*
+ * HEADLESS RUNNER
+ * Runs a population without the framework, no window, no renderer, no ImGui
+ * Start, Update and End do what the plugin does every frame, with HeadlessAgentHosts in place of the engine
+ * Runs on a fixed time step so a seed gives the same run on any machine with any number of threads, unless paths are planned in the background or there's a frame budget
+ */
+class HeadlessRunner final
+{
+public:
+	explicit HeadlessRunner(const HeadlessRunSettings& settings);
+	~HeadlessRunner();
+
+	HeadlessRunner(const HeadlessRunner&) = delete;
+	HeadlessRunner& operator=(const HeadlessRunner&) = delete;
+
+	void Start();
+	//One fixed step for every agent, false once the run is over
+	bool Update();
+	void End();
+
+	//Start, update until done, end
+	HeadlessRunStats Run();
+
+	const HeadlessRunStats& GetStats() const { return m_Stats; }
+	const AgentPopulation* GetPopulation() const { return m_pPopulation; }
+	const HeadlessAgentHost* GetHost(size_t index) const { return m_Hosts[index]; }
+
+private:
+	void UpdateStats();
+
+	HeadlessRunSettings m_Settings;
+	HeadlessRunStats m_Stats;
+
+	HeadlessWorld* m_pWorld = nullptr;
+	TaskScheduler* m_pScheduler = nullptr;
+	PathService* m_pPathService = nullptr;
+	AgentPopulation* m_pPopulation = nullptr;
+	vector<HeadlessAgentHost*> m_Hosts;
+	vector<PluginOutput> m_Outputs;
+	vector<float> m_FrameSeconds;	//Of every frame so far, for the percentiles
+};
@@ -0,0 +1,67 @@
+#include "stdafx.h"
+#include "HeadlessWorld.h"
+
+#include <random>
+
+namespace
+{
+	WorldInfo MakeWorldInfo(const HeadlessWorldSettings& settings)
+	{
+		WorldInfo worldInfo = {};
+		worldInfo.Center = b2Vec2_zero;
+		worldInfo.Dimensions = settings.Dimensions;
+		return worldInfo;
+	}
+}
+
+HeadlessWorld::HeadlessWorld(const HeadlessWorldSettings& settings)
+	: m_Settings(settings)
+	, m_WorldInfo(MakeWorldInfo(settings))
+	, m_Houses(GenerateHouses(settings))
+	, m_NavMesh(m_WorldInfo, m_Houses)
+{
+	if (m_Settings.ClusterSize <= 0)
+		return;
+
+	//Only built when there's no file made for this exact navmesh yet
+	m_pHierarchy = new NavMeshHierarchy(&m_NavMesh, m_Settings.ClusterSize);
+	if (m_Settings.HierarchyFile.empty() || !m_pHierarchy->Load(m_Settings.HierarchyFile))
+	{
+		m_pHierarchy->Build();
+		if (!m_Settings.HierarchyFile.empty())
+			m_pHierarchy->Save(m_Settings.HierarchyFile);
+	}
+}
+
+HeadlessWorld::~HeadlessWorld()
+{
+	delete m_pHierarchy;
+}
+
+vector<HouseInfo> HeadlessWorld::GenerateHouses(const HeadlessWorldSettings& settings)
+{
+	std::mt19937 random(settings.Seed);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+	vector<HouseInfo> houses;
+	const auto columns = static_cast<int>(settings.Dimensions.x / settings.HouseSpacing);
+	const auto rows = static_cast<int>(settings.Dimensions.y / settings.HouseSpacing);
+	const auto origin = -0.5f * settings.Dimensions;
+
+	//One house at most per grid cell, so they never overlap and there's always a street around them
+	for (int row = 0; row < rows; ++row)
+	{
+		for (int column = 0; column < columns; ++column)
+		{
+			if (unit(random) >= settings.HouseChance)
+				continue;
+
+			HouseInfo house = {};
+			house.Size = settings.MinHouseSize + unit(random) * (settings.MaxHouseSize - settings.MinHouseSize);
+			house.Center = origin + b2Vec2((column + 0.5f) * settings.HouseSpacing, (row + 0.5f) * settings.HouseSpacing);
+			houses.push_back(house);
+		}
+	}
+
+	return houses;
+}
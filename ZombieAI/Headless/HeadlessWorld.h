@@ -0,0 +1,74 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include "NavMesh.h"
+#include "NavMeshHierarchy.h"
+
+//How the headless world is generated and how hard it is on the agents
+struct HeadlessWorldSettings
+{
+	uint32_t Seed = 1;
+	b2Vec2 Dimensions = b2Vec2(400.f, 400.f);
+
+	//Houses on a coarse grid, each grid cell may get one
+	float HouseSpacing = 50.f;
+	float HouseChance = 0.5f;
+	b2Vec2 MinHouseSize = b2Vec2(12.f, 12.f);
+	b2Vec2 MaxHouseSize = b2Vec2(24.f, 24.f);
+
+	//Every agent keeps the last path it planned, see PathCache
+	bool PathCache = true;
+	//Cells per side of a cluster of the navmesh hierarchy the path caches plan long paths on, 0 plans everything on the navmesh
+	int ClusterSize = NavMeshHierarchy::DefaultClusterSize;
+	//Where the hierarchy is loaded from, and saved to when it had to be built, empty builds it every time
+	string HierarchyFile;
+
+	//Per agent
+	int ItemsPerHouse = 2;
+	int EnemyCount = 20;
+
+	//Agent
+	float MaxHealth = 10.f;
+	float MaxEnergy = 20.f;
+	float MaxStamina = 10.f;
+	float EnergyDrainPerSecond = 0.1f;
+	float WalkSpeed = 5.f;
+	float RunSpeed = 10.f;
+
+	//Enemies
+	float EnemySpeed = 3.f;
+	float EnemySightRange = 15.f;
+	float BiteRange = 1.5f;
+	float BiteCooldown = 1.f;
+};
+
+/*
+ * HEADLESS WORLD
+ * The layout every agent shares: the world bounds, the houses and the navmesh
+ * Read-only once built, so any number of agents on any number of threads can use one world
+ */
+class HeadlessWorld final
+{
+public:
+	explicit HeadlessWorld(const HeadlessWorldSettings& settings);
+	~HeadlessWorld();
+
+	HeadlessWorld(const HeadlessWorld&) = delete;
+	HeadlessWorld& operator=(const HeadlessWorld&) = delete;
+
+	const HeadlessWorldSettings& GetSettings() const { return m_Settings; }
+	const WorldInfo& GetWorldInfo() const { return m_WorldInfo; }
+	const vector<HouseInfo>& GetHouses() const { return m_Houses; }
+	const NavMesh& GetNavMesh() const { return m_NavMesh; }
+	//Null without a cluster size
+	const NavMeshHierarchy* GetHierarchy() const { return m_pHierarchy; }
+
+private:
+	static vector<HouseInfo> GenerateHouses(const HeadlessWorldSettings& settings);
+
+	HeadlessWorldSettings m_Settings;
+	WorldInfo m_WorldInfo;
+	vector<HouseInfo> m_Houses;
+	NavMesh m_NavMesh;
+	NavMeshHierarchy* m_pHierarchy = nullptr;
+};
@@ -0,0 +1,239 @@
+#include "stdafx.h"
+#include "NavMesh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <queue>
+
+const NavMesh::PolygonId NavMesh::InvalidPolygon;
+
+NavMesh::NavMesh(const WorldInfo& worldInfo, const vector<HouseInfo>& houses, float cellSize)
+	: m_Origin(worldInfo.Center - 0.5f * worldInfo.Dimensions)
+	, m_CellSize(cellSize)
+	, m_Columns(std::max(1, static_cast<int>(ceil(worldInfo.Dimensions.x / cellSize))))
+	, m_Rows(std::max(1, static_cast<int>(ceil(worldInfo.Dimensions.y / cellSize))))
+	, m_Walkable(m_Columns * m_Rows, 1)
+{
+	for (const auto& house : houses)
+		BlockHouse(house);
+}
+
+NavMesh::PolygonId NavMesh::GetPolygon(const b2Vec2& position) const
+{
+	const auto column = static_cast<int>(floor((position.x - m_Origin.x) / m_CellSize));
+	const auto row = static_cast<int>(floor((position.y - m_Origin.y) / m_CellSize));
+	if (column < 0 || row < 0 || column >= m_Columns || row >= m_Rows)
+		return InvalidPolygon;
+
+	return row * m_Columns + column;
+}
+
+b2Vec2 NavMesh::GetCenter(PolygonId polygon) const
+{
+	const auto column = polygon % m_Columns;
+	const auto row = polygon / m_Columns;
+	return m_Origin + b2Vec2((column + 0.5f) * m_CellSize, (row + 0.5f) * m_CellSize);
+}
+
+bool NavMesh::IsWalkable(PolygonId polygon) const
+{
+	return polygon >= 0 && polygon < static_cast<PolygonId>(m_Walkable.size()) && m_Walkable[polygon] != 0;
+}
+
+NavMesh::PolygonId NavMesh::GetClosestWalkable(const b2Vec2& position) const
+{
+	//Clamp into the world first, then look around in growing rings
+	const auto column = std::min(std::max(static_cast<int>(floor((position.x - m_Origin.x) / m_CellSize)), 0), m_Columns - 1);
+	const auto row = std::min(std::max(static_cast<int>(floor((position.y - m_Origin.y) / m_CellSize)), 0), m_Rows - 1);
+	if (IsWalkable(column, row))
+		return row * m_Columns + column;
+
+	for (int radius = 1; radius < std::max(m_Columns, m_Rows); ++radius)
+	{
+		for (int dy = -radius; dy <= radius; ++dy)
+		{
+			for (int dx = -radius; dx <= radius; ++dx)
+			{
+				if (std::abs(dx) != radius && std::abs(dy) != radius)
+					continue;
+				if (IsWalkable(column + dx, row + dy))
+					return (row + dy) * m_Columns + column + dx;
+			}
+		}
+	}
+
+	return InvalidPolygon;
+}
+
+bool NavMesh::FindPath(const b2Vec2& start, const b2Vec2& goal, vector<b2Vec2>& path) const
+{
+	vector<PolygonId> polygons;
+	return FindPath(start, goal, path, polygons);
+}
+
+bool NavMesh::FindPath(const b2Vec2& start, const b2Vec2& goal, vector<b2Vec2>& path, vector<PolygonId>& polygons) const
+{
+	return FindPath(start, goal, 0, 0, m_Columns - 1, m_Rows - 1, path, polygons);
+}
+
+bool NavMesh::FindPath(const b2Vec2& start, const b2Vec2& goal, int left, int bottom, int right, int top, vector<b2Vec2>& path, vector<PolygonId>& polygons) const
+{
+	path.clear();
+	polygons.clear();
+
+	left = std::max(left, 0);
+	bottom = std::max(bottom, 0);
+	right = std::min(right, m_Columns - 1);
+	top = std::min(top, m_Rows - 1);
+	const auto width = right - left + 1;
+	auto inBox = [=](PolygonId polygon)
+	{
+		const auto column = polygon % m_Columns;
+		const auto row = polygon / m_Columns;
+		return column >= left && column <= right && row >= bottom && row <= top;
+	};
+	auto toBox = [=](PolygonId polygon)
+	{
+		return (polygon / m_Columns - bottom) * width + polygon % m_Columns - left;
+	};
+
+	const auto startPolygon = GetClosestWalkable(start);
+	const auto goalPolygon = GetClosestWalkable(goal);
+	if (startPolygon == InvalidPolygon || goalPolygon == InvalidPolygon || !inBox(startPolygon) || !inBox(goalPolygon))
+		return false;
+
+	if (startPolygon == goalPolygon)
+	{
+		path.push_back(goal);
+		return true;
+	}
+
+	//A* over the cells
+	typedef std::pair<float, PolygonId> OpenEntry;
+	std::priority_queue<OpenEntry, vector<OpenEntry>, std::greater<OpenEntry>> open;
+	vector<float> costs(width * (top - bottom + 1), FLT_MAX);
+	vector<PolygonId> parents(costs.size(), InvalidPolygon);
+
+	costs[toBox(startPolygon)] = 0.f;
+	open.push({ Heuristic(startPolygon, goalPolygon), startPolygon });
+
+	while (!open.empty())
+	{
+		const auto current = open.top().second;
+		const auto estimate = open.top().first;
+		open.pop();
+
+		if (current == goalPolygon)
+			break;
+		//Already found a cheaper way here, same sum as when it was pushed so rounding can't skip the cheapest one
+		const auto currentCost = costs[toBox(current)];
+		if (estimate > currentCost + Heuristic(current, goalPolygon))
+			continue;
+
+		ForEachNeighbour(current, [&](PolygonId neighbour, float stepCost)
+		{
+			const auto cost = currentCost + stepCost;
+			if (!inBox(neighbour) || cost >= costs[toBox(neighbour)])
+				return;
+
+			costs[toBox(neighbour)] = cost;
+			parents[toBox(neighbour)] = current;
+			open.push({ cost + Heuristic(neighbour, goalPolygon), neighbour });
+		});
+	}
+
+	if (parents[toBox(goalPolygon)] == InvalidPolygon)
+		return false;
+
+	//Walk back from the goal
+	for (auto polygon = goalPolygon; polygon != startPolygon; polygon = parents[toBox(polygon)])
+		polygons.push_back(polygon);
+	std::reverse(polygons.begin(), polygons.end());
+
+	//Only keep the corners, skip every cell we can see past
+	auto from = start;
+	for (size_t i = 0; i + 1 < polygons.size(); ++i)
+	{
+		if (IsLineWalkable(from, GetCenter(polygons[i + 1])))
+			continue;
+
+		from = GetCenter(polygons[i]);
+		path.push_back(from);
+	}
+	path.push_back(goal);
+	return true;
+}
+
+b2Vec2 NavMesh::GetClosestPathPoint(const b2Vec2& start, const b2Vec2& goal) const
+{
+	vector<b2Vec2> path;
+	if (!FindPath(start, goal, path))
+		return goal;
+
+	return path.front();
+}
+
+bool NavMesh::IsLineWalkable(const b2Vec2& from, const b2Vec2& to) const
+{
+	//Sample at a quarter cell, fine enough to never step over a wall cell
+	const auto delta = to - from;
+	const auto steps = std::max(1, static_cast<int>(ceil(delta.Length() / (m_CellSize * 0.25f))));
+	for (int step = 0; step <= steps; ++step)
+	{
+		if (!IsWalkable(GetPolygon(from + (static_cast<float>(step) / steps) * delta)))
+			return false;
+	}
+	return true;
+}
+
+float NavMesh::Heuristic(PolygonId from, PolygonId to) const
+{
+	//Octile distance
+	const auto dx = static_cast<float>(std::abs(from % m_Columns - to % m_Columns));
+	const auto dy = static_cast<float>(std::abs(from / m_Columns - to / m_Columns));
+	return (std::max(dx, dy) + 0.41421356f * std::min(dx, dy)) * m_CellSize;
+}
+
+void NavMesh::BlockHouse(const HouseInfo& house)
+{
+	const auto bottomLeft = house.Center - 0.5f * house.Size;
+	const auto topRight = house.Center + 0.5f * house.Size;
+
+	const auto left = static_cast<int>(floor((bottomLeft.x - m_Origin.x) / m_CellSize));
+	const auto bottom = static_cast<int>(floor((bottomLeft.y - m_Origin.y) / m_CellSize));
+	const auto right = static_cast<int>(floor((topRight.x - m_Origin.x) / m_CellSize));
+	const auto top = static_cast<int>(floor((topRight.y - m_Origin.y) / m_CellSize));
+
+	//Walls all around
+	for (int column = left; column <= right; ++column)
+	{
+		SetWalkable(column, bottom, false);
+		SetWalkable(column, top, false);
+	}
+	for (int row = bottom; row <= top; ++row)
+	{
+		SetWalkable(left, row, false);
+		SetWalkable(right, row, false);
+	}
+
+	//Door in the middle of the bottom wall, two cells wide
+	const auto door = (left + right) / 2;
+	SetWalkable(door, bottom, true);
+	SetWalkable(door + 1, bottom, true);
+}
+
+void NavMesh::SetWalkable(int column, int row, bool walkable)
+{
+	if (column < 0 || row < 0 || column >= m_Columns || row >= m_Rows)
+		return;
+
+	m_Walkable[row * m_Columns + column] = walkable ? 1 : 0;
+}
+
+bool NavMesh::IsWalkable(int column, int row) const
+{
+	if (column < 0 || row < 0 || column >= m_Columns || row >= m_Rows)
+		return false;
+
+	return m_Walkable[row * m_Columns + column] != 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+
+/*
+ * NAVMESH
+ * Walkable area of the headless world as a grid of square cells, every cell is one navmesh polygon
+ * House walls block their cells, except for a door in the middle of one wall
+ * Paths are found with A* over the cells and smoothed so they only keep the corners
+ */
+class NavMesh final
+{
+public:
+	typedef int32_t PolygonId;
+	static const PolygonId InvalidPolygon = -1;
+
+	NavMesh(const WorldInfo& worldInfo, const vector<HouseInfo>& houses, float cellSize = 1.f);
+
+	//Polygon under the position, invalid outside the world
+	PolygonId GetPolygon(const b2Vec2& position) const;
+	b2Vec2 GetCenter(PolygonId polygon) const;
+	bool IsWalkable(PolygonId polygon) const;
+	size_t PolygonCount() const { return m_Walkable.size(); }
+
+	//Closest walkable polygon, the goal of a path ends up in one of these
+	PolygonId GetClosestWalkable(const b2Vec2& position) const;
+
+	//Corners from start to goal, ending at the goal itself, empty if the goal can't be reached
+	bool FindPath(const b2Vec2& start, const b2Vec2& goal, vector<b2Vec2>& path) const;
+	//Same, with every polygon the path goes through from the one after the start up to the goal
+	bool FindPath(const b2Vec2& start, const b2Vec2& goal, vector<b2Vec2>& path, vector<PolygonId>& polygons) const;
+	//Same, only searching the columns from left to right and the rows from bottom to top, ends included
+	//The search only ever touches the cells in there, so a small box is much cheaper than the whole navmesh
+	bool FindPath(const b2Vec2& start, const b2Vec2& goal, int left, int bottom, int right, int top, vector<b2Vec2>& path, vector<PolygonId>& polygons) const;
+
+	//Next point to walk to on the way to the goal, like NAVMESH_GetClosestPathPoint
+	//The goal itself if there's no path
+	b2Vec2 GetClosestPathPoint(const b2Vec2& start, const b2Vec2& goal) const;
+
+	//True if a straight walk between both points only crosses walkable polygons
+	bool IsLineWalkable(const b2Vec2& from, const b2Vec2& to) const;
+
+	//Walkable neighbours of a polygon with the cost to step there, diagonals don't cut wall corners
+	template<typename Fn>
+	void ForEachNeighbour(PolygonId polygon, const Fn& fn) const;
+
+	//Straight line cost between polygons, never more than the real cost
+	float Heuristic(PolygonId from, PolygonId to) const;
+
+	int Columns() const { return m_Columns; }
+	int Rows() const { return m_Rows; }
+	float CellSize() const { return m_CellSize; }
+
+private:
+	void BlockHouse(const HouseInfo& house);
+	void SetWalkable(int column, int row, bool walkable);
+	bool IsWalkable(int column, int row) const;
+
+	b2Vec2 m_Origin;
+	float m_CellSize;
+	int m_Columns;
+	int m_Rows;
+	vector<uint8_t> m_Walkable;
+};
+
+template<typename Fn>
+void NavMesh::ForEachNeighbour(PolygonId polygon, const Fn& fn) const
+{
+	static const float Diagonal = 1.41421356f;
+
+	const int column = polygon % m_Columns;
+	const int row = polygon / m_Columns;
+
+	for (int dy = -1; dy <= 1; ++dy)
+	{
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			if ((dx == 0 && dy == 0) || !IsWalkable(column + dx, row + dy))
+				continue;
+
+			//Going diagonally has to fit past both sides
+			if (dx != 0 && dy != 0 && (!IsWalkable(column + dx, row) || !IsWalkable(column, row + dy)))
+				continue;
+
+			fn(static_cast<PolygonId>((row + dy) * m_Columns + column + dx), (dx != 0 && dy != 0 ? Diagonal : 1.f) * m_CellSize);
+		}
+	}
+}
@@ -0,0 +1,389 @@
+#include "stdafx.h"
+#include "NavMeshHierarchy.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+const int NavMeshHierarchy::DefaultClusterSize;
+const uint32_t NavMeshHierarchy::FileHeader::FileMagic;
+const uint32_t NavMeshHierarchy::FileHeader::FileVersion;
+
+NavMeshHierarchy::NavMeshHierarchy(const NavMesh* pNavMesh, int clusterSize)
+	: m_pNavMesh(pNavMesh)
+	, m_ClusterSize(std::max(clusterSize, 2))
+	, m_ClusterColumns((pNavMesh->Columns() + m_ClusterSize - 1) / m_ClusterSize)
+	, m_ClusterRows((pNavMesh->Rows() + m_ClusterSize - 1) / m_ClusterSize)
+{
+}
+
+void NavMeshHierarchy::Build()
+{
+	typedef NavMesh::PolygonId PolygonId;
+	const auto columns = m_pNavMesh->Columns();
+	const auto rows = m_pNavMesh->Rows();
+
+	//One crossing in the middle of every open stretch of border, a stretch ends where the border does
+	vector<std::pair<PolygonId, PolygonId>> crossings;
+	auto addCrossings = [this, &crossings](int length, auto sides)
+	{
+		int runStart = -1;
+		for (int i = 0; i <= length; ++i)
+		{
+			const auto open = i < length && m_pNavMesh->IsWalkable(sides(i).first) && m_pNavMesh->IsWalkable(sides(i).second);
+			if (runStart >= 0 && (!open || i % m_ClusterSize == 0))
+			{
+				crossings.push_back(sides((runStart + i - 1) / 2));
+				runStart = -1;
+			}
+			if (open && runStart < 0)
+				runStart = i;
+		}
+	};
+	for (int clusterColumn = 0; clusterColumn + 1 < m_ClusterColumns; ++clusterColumn)
+	{
+		const auto column = (clusterColumn + 1) * m_ClusterSize - 1;
+		addCrossings(rows, [columns, column](int row) { return std::make_pair(row * columns + column, row * columns + column + 1); });
+	}
+	for (int clusterRow = 0; clusterRow + 1 < m_ClusterRows; ++clusterRow)
+	{
+		const auto row = (clusterRow + 1) * m_ClusterSize - 1;
+		addCrossings(columns, [columns, row](int column) { return std::make_pair(row * columns + column, (row + 1) * columns + column); });
+	}
+
+	//Both sides of every crossing are portals, sorted by cluster
+	vector<PolygonId> polygons;
+	for (const auto& crossing : crossings)
+	{
+		polygons.push_back(crossing.first);
+		polygons.push_back(crossing.second);
+	}
+	std::sort(polygons.begin(), polygons.end(), [this](PolygonId a, PolygonId b)
+	{
+		return std::make_pair(GetCluster(a), a) < std::make_pair(GetCluster(b), b);
+	});
+	polygons.erase(std::unique(polygons.begin(), polygons.end()), polygons.end());
+
+	std::unordered_map<PolygonId, uint32_t> indices;
+	m_Portals.clear();
+	for (const auto polygon : polygons)
+	{
+		indices[polygon] = static_cast<uint32_t>(m_Portals.size());
+		m_Portals.push_back({ polygon, GetCluster(polygon), 0, 0 });
+	}
+
+	m_ClusterPortals.assign(m_ClusterColumns * m_ClusterRows + 1, 0);
+	for (const auto& portal : m_Portals)
+		++m_ClusterPortals[portal.Cluster + 1];
+	for (size_t cluster = 1; cluster < m_ClusterPortals.size(); ++cluster)
+		m_ClusterPortals[cluster] += m_ClusterPortals[cluster - 1];
+
+	//Crossing a border is one step, going from portal to portal in a cluster is the shortest way inside it
+	vector<vector<Edge>> edges(m_Portals.size());
+	for (const auto& crossing : crossings)
+	{
+		const auto first = indices[crossing.first];
+		const auto second = indices[crossing.second];
+		edges[first].push_back({ second, m_pNavMesh->CellSize() });
+		edges[second].push_back({ first, m_pNavMesh->CellSize() });
+	}
+
+	vector<float> costs;
+	for (uint32_t portal = 0; portal < m_Portals.size(); ++portal)
+	{
+		const auto range = PortalsOf(m_Portals[portal].Cluster);
+		CostsToPortals(m_Portals[portal].Polygon, costs);
+		for (auto other = range.first; other < range.second; ++other)
+		{
+			if (other != portal && costs[other - range.first] < FLT_MAX)
+				edges[portal].push_back({ other, costs[other - range.first] });
+		}
+	}
+
+	m_Edges.clear();
+	for (uint32_t portal = 0; portal < m_Portals.size(); ++portal)
+	{
+		m_Portals[portal].FirstEdge = static_cast<uint32_t>(m_Edges.size());
+		m_Portals[portal].EdgeCount = static_cast<uint32_t>(edges[portal].size());
+		m_Edges.insert(m_Edges.end(), edges[portal].begin(), edges[portal].end());
+	}
+}
+
+bool NavMeshHierarchy::Load(const string& path)
+{
+	auto pFile = fopen(path.c_str(), "rb");
+	if (!pFile)
+		return false;
+
+	FileHeader header;
+	const auto clusterCount = static_cast<size_t>(m_ClusterColumns * m_ClusterRows);
+	if (fread(&header, sizeof(header), 1, pFile) != 1
+		|| header.Magic != FileHeader::FileMagic || header.Version != FileHeader::FileVersion
+		|| header.NavMeshHash != NavMeshHash() || header.ClusterSize != m_ClusterSize)
+	{
+		fclose(pFile);
+		return false;
+	}
+
+	vector<Portal> portals(header.PortalCount);
+	vector<Edge> edges(header.EdgeCount);
+	vector<uint32_t> clusterPortals(clusterCount + 1);
+	const auto read = fread(portals.data(), sizeof(Portal), portals.size(), pFile) == portals.size()
+		&& fread(edges.data(), sizeof(Edge), edges.size(), pFile) == edges.size()
+		&& fread(clusterPortals.data(), sizeof(uint32_t), clusterPortals.size(), pFile) == clusterPortals.size();
+	fclose(pFile);
+
+	if (!read || clusterPortals.back() != portals.size())
+		return false;
+
+	m_Portals.swap(portals);
+	m_Edges.swap(edges);
+	m_ClusterPortals.swap(clusterPortals);
+	return true;
+}
+
+bool NavMeshHierarchy::Save(const string& path) const
+{
+	auto pFile = fopen(path.c_str(), "wb");
+	if (!pFile)
+		return false;
+
+	FileHeader header = {};
+	header.Magic = FileHeader::FileMagic;
+	header.Version = FileHeader::FileVersion;
+	header.NavMeshHash = NavMeshHash();
+	header.ClusterSize = m_ClusterSize;
+	header.PortalCount = static_cast<uint32_t>(m_Portals.size());
+	header.EdgeCount = static_cast<uint32_t>(m_Edges.size());
+
+	const auto written = fwrite(&header, sizeof(header), 1, pFile) == 1
+		&& fwrite(m_Portals.data(), sizeof(Portal), m_Portals.size(), pFile) == m_Portals.size()
+		&& fwrite(m_Edges.data(), sizeof(Edge), m_Edges.size(), pFile) == m_Edges.size()
+		&& fwrite(m_ClusterPortals.data(), sizeof(uint32_t), m_ClusterPortals.size(), pFile) == m_ClusterPortals.size();
+	return fclose(pFile) == 0 && written;
+}
+
+bool NavMeshHierarchy::FindPath(const b2Vec2& start, const b2Vec2& goal, vector<b2Vec2>& path, vector<NavMesh::PolygonId>& polygons, PortalRoute& route) const
+{
+	route.Portals.clear();
+	route.Next = 0;
+	route.Goal = goal;
+
+	const auto startPolygon = m_pNavMesh->GetClosestWalkable(start);
+	const auto goalPolygon = m_pNavMesh->GetClosestWalkable(goal);
+	if (startPolygon == NavMesh::InvalidPolygon || goalPolygon == NavMesh::InvalidPolygon || m_Portals.empty())
+		return m_pNavMesh->FindPath(start, goal, path, polygons);
+
+	//Close by the navmesh is cheap enough, as long as the way there doesn't go far around
+	const auto startCluster = GetCluster(startPolygon);
+	const auto goalCluster = GetCluster(goalPolygon);
+	if (std::abs(startCluster % m_ClusterColumns - goalCluster % m_ClusterColumns) <= NearbyClusters
+		&& std::abs(startCluster / m_ClusterColumns - goalCluster / m_ClusterColumns) <= NearbyClusters)
+	{
+		ClusterBox box;
+		AddToBox(box, startCluster, 1);
+		AddToBox(box, goalCluster, 1);
+		return FindPathInBox(start, goal, box, path, polygons) || m_pNavMesh->FindPath(start, goal, path, polygons);
+	}
+
+	//A* over the portals, from every portal the start can reach in its cluster to a goal node every portal in the goal cluster leads to
+	vector<float> startCosts, goalCosts;
+	CostsToPortals(startPolygon, startCosts);
+	CostsToPortals(goalPolygon, goalCosts);
+	const auto startRange = PortalsOf(startCluster);
+	const auto goalRange = PortalsOf(goalCluster);
+
+	const auto goalNode = static_cast<uint32_t>(m_Portals.size());
+	const auto noParent = goalNode + 1;
+	auto heuristic = [this, goalNode, goalPolygon](uint32_t node)
+	{
+		return node == goalNode ? 0.f : m_pNavMesh->Heuristic(m_Portals[node].Polygon, goalPolygon);
+	};
+
+	typedef std::pair<float, uint32_t> OpenEntry;
+	std::priority_queue<OpenEntry, vector<OpenEntry>, std::greater<OpenEntry>> open;
+	vector<float> costs(m_Portals.size() + 1, FLT_MAX);
+	vector<uint32_t> parents(m_Portals.size() + 1, noParent);
+
+	for (auto portal = startRange.first; portal < startRange.second; ++portal)
+	{
+		costs[portal] = startCosts[portal - startRange.first];
+		if (costs[portal] < FLT_MAX)
+			open.push({ costs[portal] + heuristic(portal), portal });
+	}
+
+	auto relax = [&](uint32_t from, uint32_t to, float cost)
+	{
+		if (costs[from] + cost >= costs[to])
+			return;
+
+		costs[to] = costs[from] + cost;
+		parents[to] = from;
+		open.push({ costs[to] + heuristic(to), to });
+	};
+
+	while (!open.empty())
+	{
+		const auto current = open.top().second;
+		const auto estimate = open.top().first;
+		open.pop();
+
+		if (current == goalNode)
+			break;
+		//Already found a cheaper way here, same sum as when it was pushed so rounding can't skip the cheapest one
+		if (estimate > costs[current] + heuristic(current))
+			continue;
+
+		const auto& portal = m_Portals[current];
+		for (auto edge = portal.FirstEdge; edge < portal.FirstEdge + portal.EdgeCount; ++edge)
+			relax(current, m_Edges[edge].To, m_Edges[edge].Cost);
+		if (portal.Cluster == goalCluster && goalCosts[current - goalRange.first] < FLT_MAX)
+			relax(current, goalNode, goalCosts[current - goalRange.first]);
+	}
+
+	//The cells give a way around that the portals don't, only when a way in is a diagonal step past a cluster corner
+	if (costs[goalNode] == FLT_MAX)
+		return m_pNavMesh->FindPath(start, goal, path, polygons);
+
+	for (auto node = parents[goalNode]; node != noParent; node = parents[node])
+		route.Portals.push_back(m_Portals[node].Polygon);
+	std::reverse(route.Portals.begin(), route.Portals.end());
+
+	return RefineLeg(start, route, path, polygons);
+}
+
+bool NavMeshHierarchy::RefineLeg(const b2Vec2& start, PortalRoute& route, vector<b2Vec2>& path, vector<NavMesh::PolygonId>& polygons) const
+{
+	const auto startPolygon = m_pNavMesh->GetClosestWalkable(start);
+	if (startPolygon == NavMesh::InvalidPolygon || route.Portals.empty())
+		return m_pNavMesh->FindPath(start, route.Goal, path, polygons);
+
+	//Up to the portal after the last one in the cluster we're in
+	//The route can leave a cluster and come back to go around something, stopping at the first way out would walk in circles
+	const auto startCluster = GetCluster(startPolygon);
+	auto target = route.Next;
+	for (auto portal = route.Next; portal < route.Portals.size(); ++portal)
+	{
+		if (GetCluster(route.Portals[portal]) == startCluster)
+			target = portal + 1;
+	}
+
+	ClusterBox box;
+	AddToBox(box, startCluster);
+	for (auto portal = route.Next; portal < std::min(target + 1, route.Portals.size()); ++portal)
+		AddToBox(box, GetCluster(route.Portals[portal]));
+
+	//In the goal cluster, the last leg goes all the way
+	if (target >= route.Portals.size())
+	{
+		const auto goal = route.Goal;
+		AddToBox(box, GetCluster(m_pNavMesh->GetClosestWalkable(goal)), 1);
+		route.Portals.clear();
+		route.Next = 0;
+		return FindPathInBox(start, goal, box, path, polygons) || m_pNavMesh->FindPath(start, goal, path, polygons);
+	}
+
+	route.Next = target + 1;
+	const auto next = m_pNavMesh->GetCenter(route.Portals[target]);
+	return FindPathInBox(start, next, box, path, polygons) || m_pNavMesh->FindPath(start, next, path, polygons);
+}
+
+int NavMeshHierarchy::GetCluster(NavMesh::PolygonId polygon) const
+{
+	const auto column = polygon % m_pNavMesh->Columns();
+	const auto row = polygon / m_pNavMesh->Columns();
+	return (row / m_ClusterSize) * m_ClusterColumns + column / m_ClusterSize;
+}
+
+uint32_t NavMeshHierarchy::NavMeshHash() const
+{
+	//FNV-1a, same as FlatBehaviorTree::LayoutHash
+	uint32_t hash = 2166136261u;
+	auto add = [&hash](uint32_t value)
+	{
+		for (int byte = 0; byte < 4; ++byte)
+		{
+			hash ^= (value >> (byte * 8)) & 0xFF;
+			hash *= 16777619u;
+		}
+	};
+
+	uint32_t cellSize;
+	const auto cellSizeFloat = m_pNavMesh->CellSize();
+	memcpy(&cellSize, &cellSizeFloat, sizeof(cellSize));
+
+	add(static_cast<uint32_t>(m_pNavMesh->Columns()));
+	add(static_cast<uint32_t>(m_pNavMesh->Rows()));
+	add(cellSize);
+	add(static_cast<uint32_t>(m_ClusterSize));
+	for (NavMesh::PolygonId polygon = 0; polygon < static_cast<NavMesh::PolygonId>(m_pNavMesh->PolygonCount()); ++polygon)
+		add(m_pNavMesh->IsWalkable(polygon) ? 1 : 0);
+	return hash;
+}
+
+void NavMeshHierarchy::CostsToPortals(NavMesh::PolygonId from, vector<float>& costs) const
+{
+	const auto cluster = GetCluster(from);
+	const auto range = PortalsOf(cluster);
+	costs.assign(range.second - range.first, FLT_MAX);
+	if (costs.empty())
+		return;
+
+	//Dijkstra over the cells of the cluster, indexed from its bottom left cell
+	const auto columns = m_pNavMesh->Columns();
+	const auto left = (cluster % m_ClusterColumns) * m_ClusterSize;
+	const auto bottom = (cluster / m_ClusterColumns) * m_ClusterSize;
+	auto toLocal = [=](NavMesh::PolygonId polygon)
+	{
+		return (polygon / columns - bottom) * m_ClusterSize + polygon % columns - left;
+	};
+
+	typedef std::pair<float, NavMesh::PolygonId> OpenEntry;
+	std::priority_queue<OpenEntry, vector<OpenEntry>, std::greater<OpenEntry>> open;
+	vector<float> cellCosts(m_ClusterSize * m_ClusterSize, FLT_MAX);
+	cellCosts[toLocal(from)] = 0.f;
+	open.push({ 0.f, from });
+
+	while (!open.empty())
+	{
+		const auto current = open.top().second;
+		const auto cost = open.top().first;
+		open.pop();
+		if (cost > cellCosts[toLocal(current)])
+			continue;
+
+		m_pNavMesh->ForEachNeighbour(current, [&](NavMesh::PolygonId neighbour, float stepCost)
+		{
+			if (GetCluster(neighbour) != cluster || cost + stepCost >= cellCosts[toLocal(neighbour)])
+				return;
+
+			cellCosts[toLocal(neighbour)] = cost + stepCost;
+			open.push({ cost + stepCost, neighbour });
+		});
+	}
+
+	for (auto portal = range.first; portal < range.second; ++portal)
+		costs[portal - range.first] = cellCosts[toLocal(m_Portals[portal].Polygon)];
+}
+
+void NavMeshHierarchy::AddToBox(ClusterBox& box, int cluster, int margin) const
+{
+	const auto clusterColumn = cluster % m_ClusterColumns;
+	const auto clusterRow = cluster / m_ClusterColumns;
+	box.Left = std::min(box.Left, (clusterColumn - margin) * m_ClusterSize);
+	box.Bottom = std::min(box.Bottom, (clusterRow - margin) * m_ClusterSize);
+	box.Right = std::max(box.Right, (clusterColumn + margin + 1) * m_ClusterSize - 1);
+	box.Top = std::max(box.Top, (clusterRow + margin + 1) * m_ClusterSize - 1);
+}
+
+bool NavMeshHierarchy::FindPathInBox(const b2Vec2& start, const b2Vec2& goal, const ClusterBox& box, vector<b2Vec2>& path, vector<NavMesh::PolygonId>& polygons) const
+{
+	return m_pNavMesh->FindPath(start, goal, box.Left, box.Bottom, box.Right, box.Top, path, polygons);
+}
+
+std::pair<uint32_t, uint32_t> NavMeshHierarchy::PortalsOf(int cluster) const
+{
+	return std::make_pair(m_ClusterPortals[cluster], m_ClusterPortals[cluster + 1]);
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "stdafx.h"
+#include <climits>
+#include <cstdint>
+#include "NavMesh.h"
+
+/*
+ * NAVMESH HIERARCHY
+ * Hierarchical pathfinding (HPA*) over the navmesh, for goals clusters away
+ * The navmesh is cut into square clusters, every stretch of open border between two clusters gets a portal on both sides
+ * Portals in the same cluster are joined by the cost of the shortest path between them inside it, worked out once when it's built
+ * A long path is planned over the portals once, then refined on the navmesh one leg at a time, only as far as the way out of the cluster the agent is in
+ * Built once for a navmesh, and saved to a file so the next run with the same navmesh can load it instead
+ * Only for the headless navmesh, the framework's navmesh can't be read so the plugin only keeps the point it's given (PathPointCache)
+ */
+class NavMeshHierarchy final
+{
+public:
+	static const int DefaultClusterSize = 16;
+
+	//Portals a long path goes through, in order
+	struct PortalRoute
+	{
+		vector<NavMesh::PolygonId> Portals;	//Empty once the last leg went all the way to the goal
+		size_t Next = 0;	//First portal no leg has gone to yet
+		b2Vec2 Goal = b2Vec2_zero;
+	};
+
+	explicit NavMeshHierarchy(const NavMesh* pNavMesh, int clusterSize = DefaultClusterSize);
+
+	void Build();
+	//False when the file is missing or was made for another navmesh or cluster size, nothing changes then
+	bool Load(const string& path);
+	bool Save(const string& path) const;
+
+	//The whole path for a goal close by, the polygons are the ones it goes through like NavMesh::FindPath
+	//For a goal clusters away, the route over the portals and the path of its first leg, the route is empty when there's no leg after this one
+	bool FindPath(const b2Vec2& start, const b2Vec2& goal, vector<b2Vec2>& path, vector<NavMesh::PolygonId>& polygons, PortalRoute& route) const;
+	//Path of the next leg of the route, from the start up to the portal after the last one in the cluster the start is in
+	bool RefineLeg(const b2Vec2& start, PortalRoute& route, vector<b2Vec2>& path, vector<NavMesh::PolygonId>& polygons) const;
+
+	int GetCluster(NavMesh::PolygonId polygon) const;
+	int ClusterSize() const { return m_ClusterSize; }
+	size_t PortalCount() const { return m_Portals.size(); }
+	size_t EdgeCount() const { return m_Edges.size(); }
+
+private:
+	struct Portal
+	{
+		NavMesh::PolygonId Polygon;
+		int32_t Cluster;
+		uint32_t FirstEdge;
+		uint32_t EdgeCount;
+	};
+	struct Edge
+	{
+		uint32_t To;
+		float Cost;
+	};
+	//Cells the navmesh is allowed to search, grown a cluster at a time
+	struct ClusterBox
+	{
+		int Left = INT_MAX;
+		int Bottom = INT_MAX;
+		int Right = -1;
+		int Top = -1;
+	};
+	struct FileHeader
+	{
+		static const uint32_t FileMagic = 0x3148504E;	//"NPH1"
+		static const uint32_t FileVersion = 1;
+
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t NavMeshHash;	//NavMeshHash of the navmesh it was built for
+		int32_t ClusterSize;
+		uint32_t PortalCount;
+		uint32_t EdgeCount;
+	};
+
+	//Goals this many clusters away or less are planned straight on the navmesh
+	static const int NearbyClusters = 1;
+
+	//Walkable cells and cluster size, anything that would give another hierarchy
+	uint32_t NavMeshHash() const;
+
+	//Cost from the polygon to every portal of its cluster without leaving it, FLT_MAX for the ones it can't reach
+	void CostsToPortals(NavMesh::PolygonId from, vector<float>& costs) const;
+	void AddToBox(ClusterBox& box, int cluster, int margin = 0) const;
+	bool FindPathInBox(const b2Vec2& start, const b2Vec2& goal, const ClusterBox& box, vector<b2Vec2>& path, vector<NavMesh::PolygonId>& polygons) const;
+	//First and one past the last portal of a cluster, portals are sorted by cluster
+	std::pair<uint32_t, uint32_t> PortalsOf(int cluster) const;
+
+	const NavMesh* m_pNavMesh;
+	int m_ClusterSize;
+	int m_ClusterColumns;
+	int m_ClusterRows;
+
+	vector<Portal> m_Portals;
+	vector<Edge> m_Edges;
+	vector<uint32_t> m_ClusterPortals;	//Index of the first portal of every cluster, and the portal count at the end
+};
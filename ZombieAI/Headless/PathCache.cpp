@@ -0,0 +1,202 @@
+#include "stdafx.h"
+#include "PathCache.h"
+
+#include <algorithm>
+
+PathCache::~PathCache()
+{
+	CancelPlan();
+}
+
+b2Vec2 PathCache::GetClosestPathPoint(const b2Vec2& start, const b2Vec2& goal)
+{
+	//Same polygons the navmesh plans between
+	const auto startPolygon = m_pNavMesh->GetClosestWalkable(start);
+	const auto goalPolygon = m_pNavMesh->GetClosestWalkable(goal);
+
+	if (m_Pending.IsValid())
+	{
+		if (goalPolygon == m_PendingGoalPolygon)
+		{
+			PollPlan(start, startPolygon);
+		}
+		else
+		{
+			//The goal moved on before the plan came back, no use waiting for it
+			++m_Stats.Cancelled;
+			++m_Stats.GoalMoved;
+			CancelPlan();
+			Plan(start, goal, startPolygon, goalPolygon);
+		}
+	}
+
+	if (m_Pending.IsValid())
+	{
+		//Nothing to check until the plan is in
+	}
+	else if (!m_IsPlanned)
+	{
+		Plan(start, goal, startPolygon, goalPolygon);
+	}
+	else if (goalPolygon != m_GoalPolygon)
+	{
+		++m_Stats.GoalMoved;
+		Plan(start, goal, startPolygon, goalPolygon);
+	}
+	else if (!IsInCorridor(startPolygon))
+	{
+		++m_Stats.LeftCorridor;
+		Plan(start, goal, startPolygon, goalPolygon);
+	}
+	else if (!m_Route.Portals.empty() && startPolygon == m_pNavMesh->GetPolygon(m_Path.back()))
+	{
+		++m_Stats.Misses;
+		++m_Stats.Refined;
+		m_HasPath = m_pHierarchy->RefineLeg(start, m_Route, m_Path, m_Corridor);
+		Follow(start, startPolygon);
+	}
+	else
+	{
+		++m_Stats.Hits;
+		if (!m_HasPath)
+			return goal;
+
+		//Still the same polygon, the path just ends where the goal is now
+		if (m_Route.Portals.empty())
+			m_Path.back() = goal;
+
+		//Skip every corner we can already see past, the straight way there becomes part of the corridor
+		const auto nextCorner = m_NextCorner;
+		while (m_NextCorner + 1 < m_Path.size() && m_pNavMesh->IsLineWalkable(start, m_Path[m_NextCorner + 1]))
+			++m_NextCorner;
+		if (m_NextCorner != nextCorner)
+		{
+			AddToCorridor(start, m_Path[m_NextCorner]);
+			SortCorridor();
+		}
+	}
+
+	if (m_Pending.IsValid())
+	{
+		++m_Stats.Waited;
+		return Fallback(goal, goalPolygon);
+	}
+	return m_HasPath ? m_Path[m_NextCorner] : goal;
+}
+
+void PathCache::Invalidate()
+{
+	CancelPlan();
+	m_IsPlanned = false;
+	m_HasPath = false;
+	m_Route = NavMeshHierarchy::PortalRoute();
+	m_Path.clear();
+	m_Corridor.clear();
+}
+
+bool PathCache::IsInCorridor(NavMesh::PolygonId polygon) const
+{
+	return std::binary_search(m_Corridor.begin(), m_Corridor.end(), polygon);
+}
+
+void PathCache::Plan(const b2Vec2& start, const b2Vec2& goal, NavMesh::PolygonId startPolygon, NavMesh::PolygonId goalPolygon)
+{
+	++m_Stats.Misses;
+
+	//The old path stays until the new one is in, it's what the agent follows in the meantime
+	if (m_pService)
+	{
+		m_Pending = m_pService->Request(start, goal);
+		m_PendingGoalPolygon = goalPolygon;
+		return;
+	}
+
+	m_IsPlanned = true;
+	m_GoalPolygon = goalPolygon;
+	if (m_pHierarchy)
+		m_HasPath = m_pHierarchy->FindPath(start, goal, m_Path, m_Corridor, m_Route);
+	else
+		m_HasPath = m_pNavMesh->FindPath(start, goal, m_Path, m_Corridor);
+	Follow(start, startPolygon);
+}
+
+bool PathCache::PollPlan(const b2Vec2& start, NavMesh::PolygonId startPolygon)
+{
+	PathResult result;
+	const auto status = m_pService->Poll(m_Pending, result);
+	if (status == PathStatus::Pending)
+		return false;
+
+	m_Pending = PathHandle();
+	if (status == PathStatus::Stale)
+		return false;
+
+	m_IsPlanned = true;
+	m_GoalPolygon = m_PendingGoalPolygon;
+	m_HasPath = result.HasPath;
+	m_Path = std::move(result.Path);
+	m_Corridor = std::move(result.Polygons);
+	m_Route = std::move(result.Route);
+
+	//It was searched from where the agent was when it asked, following it from here joins it up with where the agent is now
+	Follow(start, startPolygon);
+	return true;
+}
+
+b2Vec2 PathCache::Fallback(const b2Vec2& goal, NavMesh::PolygonId goalPolygon)
+{
+	if (m_HasPath && m_IsPlanned && m_GoalPolygon == goalPolygon)
+		return m_Path[m_NextCorner];
+	return goal;
+}
+
+void PathCache::CancelPlan()
+{
+	if (!m_Pending.IsValid())
+		return;
+
+	m_pService->Cancel(m_Pending);
+	m_Pending = PathHandle();
+}
+
+void PathCache::Follow(const b2Vec2& start, NavMesh::PolygonId startPolygon)
+{
+	m_NextCorner = 0;
+	m_Corridor.push_back(startPolygon);
+
+	//The agent cuts across cells A* didn't pick when it walks straight from corner to corner
+	if (m_HasPath)
+	{
+		auto from = start;
+		for (const auto& corner : m_Path)
+		{
+			AddToCorridor(from, corner);
+			from = corner;
+		}
+	}
+
+	SortCorridor();
+}
+
+void PathCache::SortCorridor()
+{
+	std::sort(m_Corridor.begin(), m_Corridor.end());
+	m_Corridor.erase(std::unique(m_Corridor.begin(), m_Corridor.end()), m_Corridor.end());
+}
+
+void PathCache::AddToCorridor(const b2Vec2& from, const b2Vec2& to)
+{
+	//Same quarter cell steps as NavMesh::IsLineWalkable, with the cells around them
+	//Those steps can miss a cell the line only just clips, and the agent isn't exactly on the line anyway
+	const auto delta = to - from;
+	const auto steps = std::max(1, static_cast<int>(ceil(delta.Length() / (m_pNavMesh->CellSize() * 0.25f))));
+	for (int step = 0; step <= steps; ++step)
+	{
+		const auto polygon = m_pNavMesh->GetPolygon(from + (static_cast<float>(step) / steps) * delta);
+		if (!m_pNavMesh->IsWalkable(polygon))
+			continue;
+
+		m_Corridor.push_back(polygon);
+		m_pNavMesh->ForEachNeighbour(polygon, [this](NavMesh::PolygonId neighbour, float) { m_Corridor.push_back(neighbour); });
+	}
+}
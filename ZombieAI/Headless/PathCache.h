@@ -0,0 +1,89 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include "NavMesh.h"
+#include "NavMeshHierarchy.h"
+#include "PathService.h"
+
+struct PathCacheStats
+{
+	uint64_t Hits = 0;
+	uint64_t Misses = 0;	//Every plan, the first one included
+	uint64_t LeftCorridor = 0;	//Misses because the agent walked off the path
+	uint64_t GoalMoved = 0;	//Misses because the goal went to another polygon
+	uint64_t Refined = 0;	//Misses because the agent got to the end of the part of a long path that was refined
+	uint64_t Waited = 0;	//Calls answered with the old path or a straight line while a plan was still being searched
+	uint64_t Cancelled = 0;	//Plans dropped before they came back because the goal moved again
+
+	PathCacheStats& operator+=(const PathCacheStats& other)
+	{
+		Hits += other.Hits;
+		Misses += other.Misses;
+		LeftCorridor += other.LeftCorridor;
+		GoalMoved += other.GoalMoved;
+		Refined += other.Refined;
+		Waited += other.Waited;
+		Cancelled += other.Cancelled;
+		return *this;
+	}
+};
+
+/*
+ * PATH CACHE
+ * The last path one agent planned, keyed by the polygon it ends in and the corridor of polygons it goes through
+ * Asking for the next path point again only plans a new path when the goal moved to another polygon or the agent left the corridor
+ * Otherwise it follows the corners it already has, moving on to the next one as soon as it can be walked to in a straight line
+ * The navmesh never changes, so a path stays good for as long as those two hold
+ * With a hierarchy, a goal clusters away gets a route over its portals, the next leg is refined once the agent gets to the end of this one
+ * With a path service, plans are searched in the background, the agent heads back to the old path or straight to the goal until they're in
+ */
+class PathCache final
+{
+public:
+	//The service has to search on the same navmesh and hierarchy
+	explicit PathCache(const NavMesh* pNavMesh, const NavMeshHierarchy* pHierarchy = nullptr, PathService* pService = nullptr)
+		: m_pNavMesh(pNavMesh)
+		, m_pHierarchy(pHierarchy)
+		, m_pService(pService)
+	{}
+	~PathCache();
+
+	PathCache(const PathCache&) = delete;
+	PathCache& operator=(const PathCache&) = delete;
+
+	//Next point to walk to on the way to the goal, like NavMesh::GetClosestPathPoint
+	b2Vec2 GetClosestPathPoint(const b2Vec2& start, const b2Vec2& goal);
+	//Forget the path and any plan still being searched, the next call plans a new one
+	void Invalidate();
+
+	const PathCacheStats& GetStats() const { return m_Stats; }
+
+private:
+	bool IsInCorridor(NavMesh::PolygonId polygon) const;
+	void Plan(const b2Vec2& start, const b2Vec2& goal, NavMesh::PolygonId startPolygon, NavMesh::PolygonId goalPolygon);
+	//Takes the plan the service came back with, false while it's still being searched
+	bool PollPlan(const b2Vec2& start, NavMesh::PolygonId startPolygon);
+	//Where to go while waiting for a plan, back to the old path when it went to the same goal, straight there otherwise
+	b2Vec2 Fallback(const b2Vec2& goal, NavMesh::PolygonId goalPolygon);
+	void CancelPlan();
+	//Corridor and corners of a path that was just planned from start
+	void Follow(const b2Vec2& start, NavMesh::PolygonId startPolygon);
+	void AddToCorridor(const b2Vec2& from, const b2Vec2& to);
+	void SortCorridor();
+
+	const NavMesh* m_pNavMesh;
+	const NavMeshHierarchy* m_pHierarchy;
+	PathService* m_pService;
+	PathCacheStats m_Stats;
+
+	PathHandle m_Pending;	//Plan the service is still searching
+	NavMesh::PolygonId m_PendingGoalPolygon = NavMesh::InvalidPolygon;
+
+	bool m_IsPlanned = false;
+	bool m_HasPath = false;	//False when the goal couldn't be reached
+	NavMeshHierarchy::PortalRoute m_Route;	//Legs still to go, the path only goes as far as the next cluster while there are any
+	NavMesh::PolygonId m_GoalPolygon = NavMesh::InvalidPolygon;
+	vector<b2Vec2> m_Path;
+	size_t m_NextCorner = 0;
+	vector<NavMesh::PolygonId> m_Corridor;	//Sorted
+};
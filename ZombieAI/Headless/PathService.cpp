@@ -0,0 +1,136 @@
+#include "stdafx.h"
+#include "PathService.h"
+
+const uint32_t PathHandle::InvalidIndex;
+
+PathService::PathService(const NavMesh* pNavMesh, const NavMeshHierarchy* pHierarchy, size_t threadCount)
+	: m_pNavMesh(pNavMesh)
+	, m_pHierarchy(pHierarchy)
+{
+	for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i)
+		m_Threads.push_back(std::thread(&PathService::WorkerLoop, this));
+}
+
+PathService::~PathService()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+	}
+	m_WorkAvailable.notify_all();
+
+	for (auto& thread : m_Threads)
+		thread.join();
+}
+
+PathHandle PathService::Request(const b2Vec2& start, const b2Vec2& goal)
+{
+	PathHandle handle;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_FreeSlots.empty())
+		{
+			handle.Index = static_cast<uint32_t>(m_Slots.size());
+			m_Slots.push_back(Slot());
+		}
+		else
+		{
+			handle.Index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+
+		auto& slot = m_Slots[handle.Index];
+		handle.Generation = slot.Generation;
+		slot.State = SlotState::Queued;
+		slot.Start = start;
+		slot.Goal = goal;
+		m_Queue.push_back(handle);
+	}
+	m_WorkAvailable.notify_one();
+	return handle;
+}
+
+PathStatus PathService::Poll(const PathHandle& handle, PathResult& result)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (!IsCurrent(handle) || m_Slots[handle.Index].State == SlotState::Cancelled)
+		return PathStatus::Stale;
+	if (m_Slots[handle.Index].State != SlotState::Done)
+		return PathStatus::Pending;
+
+	result = std::move(m_Slots[handle.Index].Result);
+	Free(handle.Index);
+	return PathStatus::Done;
+}
+
+void PathService::Cancel(const PathHandle& handle)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (!IsCurrent(handle))
+		return;
+
+	//A running search can't be stopped, its worker frees the slot when it's done
+	auto& slot = m_Slots[handle.Index];
+	if (slot.State == SlotState::Running)
+		slot.State = SlotState::Cancelled;
+	else if (slot.State != SlotState::Cancelled)
+		Free(handle.Index);
+}
+
+void PathService::WorkerLoop()
+{
+	for (;;)
+	{
+		PathHandle handle;
+		b2Vec2 start, goal;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkAvailable.wait(lock, [this]() { return m_Quit || !m_Queue.empty(); });
+			if (m_Quit)
+				return;
+
+			handle = m_Queue.front();
+			m_Queue.pop_front();
+			if (!IsCurrent(handle) || m_Slots[handle.Index].State != SlotState::Queued)
+				continue;
+
+			auto& slot = m_Slots[handle.Index];
+			slot.State = SlotState::Running;
+			start = slot.Start;
+			goal = slot.Goal;
+		}
+
+		//Both only read the navmesh, any number of workers can search at once
+		PathResult result;
+		if (m_pHierarchy)
+			result.HasPath = m_pHierarchy->FindPath(start, goal, result.Path, result.Polygons, result.Route);
+		else
+			result.HasPath = m_pNavMesh->FindPath(start, goal, result.Path, result.Polygons);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto& slot = m_Slots[handle.Index];
+		if (slot.State == SlotState::Cancelled)
+		{
+			Free(handle.Index);
+			continue;
+		}
+
+		slot.Result = std::move(result);
+		slot.State = SlotState::Done;
+	}
+}
+
+bool PathService::IsCurrent(const PathHandle& handle) const
+{
+	return handle.IsValid() && handle.Index < m_Slots.size()
+		&& m_Slots[handle.Index].Generation == handle.Generation && m_Slots[handle.Index].State != SlotState::Free;
+}
+
+void PathService::Free(uint32_t index)
+{
+	auto& slot = m_Slots[index];
+	slot.State = SlotState::Free;
+	slot.Result = PathResult();
+	++slot.Generation;
+	m_FreeSlots.push_back(index);
+}
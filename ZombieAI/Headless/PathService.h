@@ -0,0 +1,95 @@
+#pragma once
+#include "stdafx.h"
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "NavMesh.h"
+#include "NavMeshHierarchy.h"
+
+//Refers to one path request, stale once its result was picked up or it was cancelled
+struct PathHandle
+{
+	static const uint32_t InvalidIndex = UINT32_MAX;
+
+	uint32_t Index = InvalidIndex;
+	uint32_t Generation = 0;
+
+	bool IsValid() const { return Index != InvalidIndex; }
+};
+
+//What a path search found, the same things NavMeshHierarchy::FindPath hands back
+struct PathResult
+{
+	bool HasPath = false;
+	vector<b2Vec2> Path;
+	vector<NavMesh::PolygonId> Polygons;
+	NavMeshHierarchy::PortalRoute Route;
+};
+
+enum class PathStatus
+{
+	Pending,	//Still queued or being searched
+	Done,	//The result was moved out, the handle is stale now
+	Stale	//Picked up or cancelled already
+};
+
+/*
+ * PATH SERVICE
+ * Path searches on worker threads of their own, so a long one never holds up the frame that asked for it
+ * Ask for a path, keep the handle, and poll it on later frames until the result is there
+ * Cancel a request as soon as it isn't wanted anymore, a queued one is dropped and a running one is thrown away when it's done
+ * Results come back whenever they're ready, a run using it isn't reproducible frame for frame
+ * Only the headless host uses it, the plugin asks the framework's navmesh on the frame it steers
+ */
+class PathService final
+{
+public:
+	//Searches on the hierarchy when there is one, straight on the navmesh otherwise
+	PathService(const NavMesh* pNavMesh, const NavMeshHierarchy* pHierarchy, size_t threadCount);
+	~PathService();
+
+	PathService(const PathService&) = delete;
+	PathService& operator=(const PathService&) = delete;
+
+	PathHandle Request(const b2Vec2& start, const b2Vec2& goal);
+	PathStatus Poll(const PathHandle& handle, PathResult& result);
+	void Cancel(const PathHandle& handle);
+
+private:
+	enum class SlotState : uint8_t
+	{
+		Free,
+		Queued,
+		Running,
+		Cancelled,	//Still running, freed when it's done
+		Done
+	};
+	struct Slot
+	{
+		uint32_t Generation = 0;
+		SlotState State = SlotState::Free;
+		b2Vec2 Start = b2Vec2_zero;
+		b2Vec2 Goal = b2Vec2_zero;
+		PathResult Result;
+	};
+
+	void WorkerLoop();
+	bool IsCurrent(const PathHandle& handle) const;
+	void Free(uint32_t index);
+
+	const NavMesh* m_pNavMesh;
+	const NavMeshHierarchy* m_pHierarchy;
+
+	//Everything below is only touched with the mutex held
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	vector<Slot> m_Slots;
+	vector<uint32_t> m_FreeSlots;
+	std::deque<PathHandle> m_Queue;	//A cancelled request stays in here, its handle doesn't match its slot anymore
+	bool m_Quit = false;
+
+	vector<std::thread> m_Threads;
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include <unordered_map>
+
+//Stable reference to a house in the registry
+//Goes stale when the registry is cleared, so it can't point at a house from a previous round
+struct HouseHandle
+{
+	static const uint32_t InvalidIndex = UINT32_MAX;
+
+	uint32_t Index = InvalidIndex;
+	uint32_t Generation = 0;
+
+	bool IsValid() const { return Index != InvalidIndex; }
+};
+
+//Every house we know about
+//Houses are found by a hash of their center, and the unchecked ones are kept apart so picking the next target is O(1)
+class HouseRegistry final
+{
+public:
+	//Remember a new house, returns false if we already know about it
+	bool Add(const HouseInfo& houseInfo)
+	{
+		const auto key = ToKey(houseInfo.Center);
+		if (m_CenterIndex.find(key) != m_CenterIndex.end())
+			return false;
+
+		const auto index = static_cast<uint32_t>(m_Houses.size());
+		m_Houses.push_back(House(houseInfo, false));
+		m_CenterIndex[key] = index;
+		m_Unchecked.push_back(index);
+		return true;
+	}
+
+	HouseHandle Find(const b2Vec2& center) const
+	{
+		auto it = m_CenterIndex.find(ToKey(center));
+		if (it == m_CenterIndex.end())
+			return HouseHandle();
+
+		return MakeHandle(it->second);
+	}
+
+	//Returns nullptr if the handle is invalid or stale
+	const House* Get(const HouseHandle& handle) const
+	{
+		if (!IsCurrent(handle))
+			return nullptr;
+
+		return &m_Houses[handle.Index];
+	}
+
+	//Returns false if the handle is stale or the house was checked already
+	bool MarkChecked(const HouseHandle& handle)
+	{
+		if (!IsCurrent(handle) || m_Houses[handle.Index].m_Checked)
+			return false;
+
+		m_Houses[handle.Index].m_Checked = true;
+
+		//Keep the most recent unchecked house on top, checked houses further down are dropped once they surface
+		while (!m_Unchecked.empty() && m_Houses[m_Unchecked.back()].m_Checked)
+			m_Unchecked.pop_back();
+
+		return true;
+	}
+
+	//Most recently discovered house we haven't checked yet, invalid if there is none
+	HouseHandle NextUnchecked() const
+	{
+		if (m_Unchecked.empty())
+			return HouseHandle();
+
+		return MakeHandle(m_Unchecked.back());
+	}
+
+	//Forget every house, handles given out before this point go stale
+	void Clear()
+	{
+		m_Houses.clear();
+		m_CenterIndex.clear();
+		m_Unchecked.clear();
+		++m_Generation;
+	}
+
+	size_t Size() const { return m_Houses.size(); }
+	bool Empty() const { return m_Houses.empty(); }
+
+	vector<House>::const_iterator begin() const { return m_Houses.begin(); }
+	vector<House>::const_iterator end() const { return m_Houses.end(); }
+
+private:
+	typedef uint64_t CenterKey;
+
+	//Centers come straight from the world, so quantizing finely only guards against float noise
+	static CenterKey ToKey(const b2Vec2& center)
+	{
+		const auto x = static_cast<int32_t>(floor(center.x * 100.f + 0.5f));
+		const auto y = static_cast<int32_t>(floor(center.y * 100.f + 0.5f));
+		return (static_cast<CenterKey>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
+	HouseHandle MakeHandle(uint32_t index) const
+	{
+		HouseHandle handle;
+		handle.Index = index;
+		handle.Generation = m_Generation;
+		return handle;
+	}
+
+	bool IsCurrent(const HouseHandle& handle) const
+	{
+		return handle.Generation == m_Generation && handle.Index < m_Houses.size();
+	}
+
+	vector<House> m_Houses;
+	std::unordered_map<CenterKey, uint32_t> m_CenterIndex;
+	vector<uint32_t> m_Unchecked;
+	uint32_t m_Generation = 0;
+};
@@ -0,0 +1,159 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include "AgentHost.h"
+
+//Mirror of the agent's inventory, kept up to date by going through it whenever an item is added, used or removed
+//Slots are kept in one bitmask per item type, and the health or energy an item gives is read once when it goes in
+//Finding an item of a type is a bit scan, picking the best one only looks at the slots of that type
+class InventoryIndex final
+{
+public:
+	static const int MaxSlots = 32;
+	static const int MaxItemTypes = 8;
+	typedef uint32_t SlotMask;
+
+	//Read the whole inventory from the host, only needed when it could have changed behind our back
+	void Sync(IAgentHost* pHost)
+	{
+		*this = InventoryIndex();
+		m_Capacity = std::min(pHost->INVENTORY_GetCapacity(), MaxSlots);
+
+		for (int slot = 0; slot < m_Capacity; ++slot)
+		{
+			ItemInfo item;
+			if (pHost->INVENTORY_GetItem(slot, item))
+				Store(pHost, slot, item);
+		}
+	}
+
+	//Same as the host calls, the mirror only changes when the host accepted the change
+	//Slots outside the inventory are still handed to the host, dropping an item that way is on purpose
+	bool Add(IAgentHost* pHost, int slot, const ItemInfo& item)
+	{
+		if (!pHost->INVENTORY_AddItem(slot, item))
+			return false;
+
+		if (IsValidSlot(slot))
+			Store(pHost, slot, item);
+		return true;
+	}
+	bool Use(IAgentHost* pHost, int slot)
+	{
+		if (!pHost->INVENTORY_UseItem(slot))
+			return false;
+
+		//Used up, it's still there until it's removed
+		if (IsValidSlot(slot))
+			m_Amounts[slot] = 0;
+		return true;
+	}
+	bool Remove(IAgentHost* pHost, int slot)
+	{
+		if (!pHost->INVENTORY_RemoveItem(slot))
+			return false;
+
+		if (IsValidSlot(slot))
+		{
+			const auto bit = SlotMask(1) << slot;
+			m_Used &= ~bit;
+			m_HasAmount &= ~bit;
+			for (auto& slots : m_SlotsOfType)
+				slots &= ~bit;
+			m_Amounts[slot] = 0;
+		}
+		return true;
+	}
+
+	int Capacity() const { return m_Capacity; }
+	bool IsUsed(int slot) const { return IsValidSlot(slot) && (m_Used & (SlotMask(1) << slot)) != 0; }
+	const ItemInfo& GetItem(int slot) const { return m_Items[slot]; }
+	//Health or energy the item in this slot gives, 0 for anything else
+	int GetAmount(int slot) const { return m_Amounts[slot]; }
+
+	SlotMask SlotsOf(eItemType type) const
+	{
+		return IsValidType(type) ? m_SlotsOfType[type] : 0;
+	}
+	SlotMask FreeSlots() const { return ~m_Used & SlotsBelow(m_Capacity); }
+	//Slots 0 up to endSlot, not including endSlot
+	static SlotMask SlotsBelow(int endSlot)
+	{
+		return endSlot >= MaxSlots ? ~SlotMask(0) : (SlotMask(1) << std::max(endSlot, 0)) - 1;
+	}
+
+	//Lowest slot in the mask, -1 if it's empty
+	static int LowestSlot(SlotMask slots)
+	{
+		if (slots == 0)
+			return -1;
+
+		int slot = 0;
+		while ((slots & 1) == 0)
+		{
+			slots >>= 1;
+			++slot;
+		}
+		return slot;
+	}
+
+	//Lowest slot holding an item of this type, -1 if there is none
+	int FirstOf(eItemType type) const
+	{
+		return LowestSlot(SlotsOf(type));
+	}
+
+	//Slot of this type that gives the least without wasting a whole point of what's missing, -1 if there is none
+	//Keeps the bigger ones for when more is missing, ties go to the highest slot, items without a known amount are skipped
+	int BestFit(eItemType type, float missing) const
+	{
+		int bestSlot = -1;
+		int bestLeft = -1;
+
+		for (auto slots = SlotsOf(type) & m_HasAmount; slots != 0; slots &= slots - 1)
+		{
+			const auto slot = LowestSlot(slots);
+			const auto left = static_cast<int>(missing - m_Amounts[slot]);
+			if (left >= 0 && left >= bestLeft)
+			{
+				bestSlot = slot;
+				bestLeft = left;
+			}
+		}
+		return bestSlot;
+	}
+
+private:
+	bool IsValidSlot(int slot) const { return slot >= 0 && slot < m_Capacity; }
+	static bool IsValidType(eItemType type) { return type >= 0 && type < MaxItemTypes; }
+
+	void Store(IAgentHost* pHost, int slot, const ItemInfo& item)
+	{
+		const auto bit = SlotMask(1) << slot;
+		m_Used |= bit;
+		m_Items[slot] = item;
+		if (IsValidType(item.Type))
+			m_SlotsOfType[item.Type] |= bit;
+
+		//The only metadata the leaves ever ask for
+		int amount = 0;
+		auto hasAmount = false;
+		if (item.Type == HEALTH)
+			hasAmount = pHost->ITEM_GetMetadata(item, "health", amount);
+		else if (item.Type == FOOD)
+			hasAmount = pHost->ITEM_GetMetadata(item, "energy", amount);
+
+		m_Amounts[slot] = hasAmount ? amount : 0;
+		if (hasAmount)
+			m_HasAmount |= bit;
+		else
+			m_HasAmount &= ~bit;
+	}
+
+	int m_Capacity = 0;
+	SlotMask m_Used = 0;
+	SlotMask m_HasAmount = 0;
+	SlotMask m_SlotsOfType[MaxItemTypes] = {};
+	ItemInfo m_Items[MaxSlots] = {};
+	int m_Amounts[MaxSlots] = {};
+};
@@ -0,0 +1,201 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include <unordered_map>
+
+//Items we remember the location of, hashed on their quantized position
+//Checking if an item is already known and finding items around a point only look at the cells they overlap
+//Forgetting one moves the last item into its place, the order they were found in is kept on the side for Newest
+class ItemStore final
+{
+public:
+	explicit ItemStore(float cellSize = 5.f, float matchRadius = 0.1f)
+		: m_CellSize(cellSize)
+		, m_MatchRadius(matchRadius)
+	{}
+
+	//Remember a new item, returns false if we already know about it
+	bool Add(const EntityInfo& item)
+	{
+		if (Contains(item.Position))
+			return false;
+
+		m_Cells[ToKey(item.Position)].push_back(m_Items.size());
+		m_OrderSlots.push_back(m_Order.size());
+		m_Order.push_back(m_Items.size());
+		m_Items.push_back(item);
+		return true;
+	}
+
+	//Forget the item at this position, returns false if we didn't know about it
+	bool Remove(const b2Vec2& position)
+	{
+		size_t index = 0;
+		if (!Find(position, index))
+			return false;
+
+		EraseFromCell(m_Items[index].Position, index);
+		m_Order[m_OrderSlots[index]] = Forgotten;
+
+		//The last item fills the hole, only its own cell and place in the order refer to it
+		const auto last = m_Items.size() - 1;
+		if (index != last)
+		{
+			ReplaceInCell(m_Items[last].Position, last, index);
+			m_Items[index] = m_Items[last];
+			m_OrderSlots[index] = m_OrderSlots[last];
+			m_Order[m_OrderSlots[index]] = index;
+		}
+		m_Items.pop_back();
+		m_OrderSlots.pop_back();
+
+		TrimOrder();
+		return true;
+	}
+
+	bool Contains(const b2Vec2& position) const
+	{
+		size_t index = 0;
+		return Find(position, index);
+	}
+
+	//Call fn for every item within radius of center
+	template<typename Fn>
+	void ForEachInRadius(const b2Vec2& center, float radius, Fn fn) const
+	{
+		const float radiusSquared = radius * radius;
+		const int minX = Quantize(center.x - radius), maxX = Quantize(center.x + radius);
+		const int minY = Quantize(center.y - radius), maxY = Quantize(center.y + radius);
+
+		for (int x = minX; x <= maxX; ++x)
+		{
+			for (int y = minY; y <= maxY; ++y)
+			{
+				auto cell = m_Cells.find(ToKey(x, y));
+				if (cell == m_Cells.end())
+					continue;
+
+				for (auto index : cell->second)
+				{
+					if ((m_Items[index].Position - center).LengthSquared() <= radiusSquared)
+						fn(m_Items[index]);
+				}
+			}
+		}
+	}
+
+	void Clear()
+	{
+		m_Items.clear();
+		m_Cells.clear();
+		m_Order.clear();
+		m_OrderSlots.clear();
+	}
+
+	size_t Size() const { return m_Items.size(); }
+	bool Empty() const { return m_Items.empty(); }
+
+	//Most recently remembered item that's still remembered
+	const EntityInfo& Newest() const { return m_Items[m_Order.back()]; }
+
+	//Not in the order they were found
+	vector<EntityInfo>::const_iterator begin() const { return m_Items.begin(); }
+	vector<EntityInfo>::const_iterator end() const { return m_Items.end(); }
+
+private:
+	typedef uint64_t CellKey;
+
+	int Quantize(float value) const
+	{
+		return static_cast<int>(floor(value / m_CellSize));
+	}
+	CellKey ToKey(int x, int y) const
+	{
+		return (static_cast<CellKey>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+	CellKey ToKey(const b2Vec2& position) const
+	{
+		return ToKey(Quantize(position.x), Quantize(position.y));
+	}
+
+	bool Find(const b2Vec2& position, size_t& index) const
+	{
+		bool found = false;
+		ForEachInRadius(position, m_MatchRadius, [&](const EntityInfo& item)
+		{
+			if (!found)
+			{
+				index = &item - m_Items.data();
+				found = true;
+			}
+		});
+		return found;
+	}
+
+	void EraseFromCell(const b2Vec2& position, size_t index)
+	{
+		auto cell = m_Cells.find(ToKey(position));
+		if (cell == m_Cells.end())
+			return;
+
+		auto& indices = cell->second;
+		for (auto it = indices.begin(); it != indices.end(); ++it)
+		{
+			if (*it == index)
+			{
+				*it = indices.back();
+				indices.pop_back();
+				break;
+			}
+		}
+
+		//Cells only stay around while there's an item in them
+		if (indices.empty())
+			m_Cells.erase(cell);
+	}
+
+	void ReplaceInCell(const b2Vec2& position, size_t from, size_t to)
+	{
+		auto cell = m_Cells.find(ToKey(position));
+		if (cell == m_Cells.end())
+			return;
+
+		for (auto& index : cell->second)
+		{
+			if (index == from)
+			{
+				index = to;
+				return;
+			}
+		}
+	}
+
+	//Forgotten items are only dropped from the order once they're at the end of it, or once they're half of it
+	void TrimOrder()
+	{
+		while (!m_Order.empty() && m_Order.back() == Forgotten)
+			m_Order.pop_back();
+
+		if (m_Order.size() <= 2 * m_Items.size() + 16)
+			return;
+
+		size_t slot = 0;
+		for (auto index : m_Order)
+		{
+			if (index == Forgotten)
+				continue;
+			m_OrderSlots[index] = slot;
+			m_Order[slot++] = index;
+		}
+		m_Order.resize(slot);
+	}
+
+	static const size_t Forgotten = SIZE_MAX;
+
+	float m_CellSize;
+	float m_MatchRadius;
+	vector<EntityInfo> m_Items;
+	std::unordered_map<CellKey, vector<size_t>> m_Cells;
+	vector<size_t> m_Order;	//Item indices in the order they were found, Forgotten where one was forgotten since
+	vector<size_t> m_OrderSlots;	//Where every item is in m_Order
+};
@@ -0,0 +1,232 @@
+#include "stdafx.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+std::atomic<bool> Logger::s_Running(false);
+std::atomic<uint8_t> Logger::s_Level(static_cast<uint8_t>(LogLevel::Verbose));
+std::atomic<uint32_t> Logger::s_Categories(~0u);
+std::atomic<uint32_t> Logger::s_RateLimit(5);
+
+namespace
+{
+	//One message, a whole number of cache lines
+	struct LogEntry
+	{
+		uint64_t Sequence;
+		LogLevel Level;
+		LogCategory Category;
+		char Message[118];
+	};
+	static_assert(sizeof(LogEntry) == 128, "LogEntry should stay two cache lines");
+
+	//Single producer, single consumer: the thread that owns it writes, the flush thread reads
+	struct LogRing
+	{
+		static const uint32_t Capacity = 512;
+
+		LogEntry Entries[Capacity];
+		std::atomic<uint32_t> Head{ 0 };	//Next slot the owner writes
+		std::atomic<uint32_t> Tail{ 0 };	//Next slot the flush thread reads
+		std::atomic<uint32_t> Dropped{ 0 };
+	};
+
+	const char* const s_Tags[] = { "[AI]", "[STATS]", "[HOUSE]", "[Item]", "[WORLD]", "[STEERING CHANGE]" };
+	static_assert(sizeof(s_Tags) / sizeof(s_Tags[0]) == static_cast<size_t>(LogCategory::Count), "Every category needs a tag");
+
+	//Rings live as long as the process, a thread that's gone just leaves an empty ring behind
+	std::mutex s_RingsMutex;
+	vector<std::unique_ptr<LogRing>> s_Rings;
+	thread_local LogRing* t_pRing = nullptr;
+
+	std::atomic<uint64_t> s_Sequence(0);
+
+	//Only one thread drains at a time, the flush thread or whoever calls Flush
+	std::mutex s_DrainMutex;
+	vector<LogEntry> s_Drained;
+	FILE* s_pOutput = nullptr;
+
+	std::mutex s_FlushMutex;
+	std::condition_variable s_FlushWake;
+	bool s_StopFlushing = false;
+	std::thread s_FlushThread;
+
+	LogRing* GetRing()
+	{
+		if (!t_pRing)
+		{
+			std::lock_guard<std::mutex> lock(s_RingsMutex);
+			s_Rings.push_back(std::unique_ptr<LogRing>(new LogRing()));
+			t_pRing = s_Rings.back().get();
+		}
+		return t_pRing;
+	}
+
+	int64_t NowMilliseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void Drain()
+	{
+		std::lock_guard<std::mutex> drainLock(s_DrainMutex);
+		if (!s_pOutput)
+			return;
+
+		uint32_t dropped = 0;
+		{
+			std::lock_guard<std::mutex> ringsLock(s_RingsMutex);
+			for (auto& pRing : s_Rings)
+			{
+				const auto head = pRing->Head.load(std::memory_order_acquire);
+				auto tail = pRing->Tail.load(std::memory_order_relaxed);
+				for (; tail != head; ++tail)
+					s_Drained.push_back(pRing->Entries[tail % LogRing::Capacity]);
+
+				pRing->Tail.store(tail, std::memory_order_release);
+				dropped += pRing->Dropped.exchange(0, std::memory_order_relaxed);
+			}
+		}
+
+		//Every thread's messages are in order already, this puts the threads in order with each other
+		std::sort(s_Drained.begin(), s_Drained.end(), [](const LogEntry& a, const LogEntry& b)
+		{
+			return a.Sequence < b.Sequence;
+		});
+
+		for (const auto& entry : s_Drained)
+		{
+			const auto pTag = s_Tags[static_cast<size_t>(entry.Category)];
+			switch (entry.Level)
+			{
+			case LogLevel::Warning:
+				fprintf(s_pOutput, "%s[WARNING] %s\n", pTag, entry.Message);
+				break;
+			case LogLevel::Error:
+				fprintf(s_pOutput, "%s[ERROR] %s\n", pTag, entry.Message);
+				break;
+			default:
+				fprintf(s_pOutput, "%s %s\n", pTag, entry.Message);
+				break;
+			}
+		}
+		if (dropped > 0)
+			fprintf(s_pOutput, "[AI][WARNING] Log rings were full, dropped %u messages.\n", dropped);
+
+		if (!s_Drained.empty() || dropped > 0)
+			fflush(s_pOutput);
+		s_Drained.clear();
+	}
+
+	void FlushLoop()
+	{
+		std::unique_lock<std::mutex> lock(s_FlushMutex);
+		while (!s_StopFlushing)
+		{
+			//Producers never wake this thread, that would take a lock on the hot path
+			s_FlushWake.wait_for(lock, std::chrono::milliseconds(20));
+
+			lock.unlock();
+			Drain();
+			lock.lock();
+		}
+	}
+}
+
+void Logger::Start(FILE* pOutput)
+{
+	if (s_Running.load())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(s_DrainMutex);
+		s_pOutput = pOutput;
+	}
+
+	s_StopFlushing = false;
+	s_FlushThread = std::thread(FlushLoop);
+	s_Running.store(true);
+}
+
+void Logger::Stop()
+{
+	if (!s_Running.exchange(false))
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(s_FlushMutex);
+		s_StopFlushing = true;
+	}
+	s_FlushWake.notify_one();
+	s_FlushThread.join();
+
+	//Whatever came in while the thread was stopping
+	Drain();
+}
+
+void Logger::Flush()
+{
+	Drain();
+}
+
+void Logger::SetCategoryEnabled(LogCategory category, bool enabled)
+{
+	const auto bit = 1u << static_cast<uint32_t>(category);
+	if (enabled)
+		s_Categories.fetch_or(bit, std::memory_order_relaxed);
+	else
+		s_Categories.fetch_and(~bit, std::memory_order_relaxed);
+}
+
+bool Logger::Admit(LogSite& site)
+{
+	const auto limit = s_RateLimit.load(std::memory_order_relaxed);
+	if (limit == 0)
+		return true;
+
+	//Whoever moves the window on starts the count over
+	const auto now = NowMilliseconds();
+	auto windowStart = site.WindowStart.load(std::memory_order_relaxed);
+	if (now - windowStart >= 1000 && site.WindowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+		site.Count.store(0, std::memory_order_relaxed);
+
+	if (site.Count.fetch_add(1, std::memory_order_relaxed) < limit)
+		return true;
+
+	site.Suppressed.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+void Logger::Write(LogSite& site, LogLevel level, LogCategory category, const char* format, ...)
+{
+	auto pRing = GetRing();
+	const auto head = pRing->Head.load(std::memory_order_relaxed);
+	if (head - pRing->Tail.load(std::memory_order_acquire) >= LogRing::Capacity)
+	{
+		pRing->Dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	auto& entry = pRing->Entries[head % LogRing::Capacity];
+	entry.Sequence = s_Sequence.fetch_add(1, std::memory_order_relaxed);
+	entry.Level = level;
+	entry.Category = category;
+
+	va_list args;
+	va_start(args, format);
+	auto length = vsnprintf(entry.Message, sizeof(entry.Message), format, args);
+	va_end(args);
+
+	//Say how many of these the rate limit held back since the last one
+	const auto suppressed = site.Suppressed.exchange(0, std::memory_order_relaxed);
+	if (suppressed > 0 && length >= 0 && static_cast<size_t>(length) < sizeof(entry.Message))
+		snprintf(entry.Message + length, sizeof(entry.Message) - length, " (%u more suppressed)", suppressed);
+
+	pRing->Head.store(head + 1, std::memory_order_release);
+}
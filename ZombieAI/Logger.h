@@ -0,0 +1,136 @@
+#pragma once
+#include "stdafx.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+/*
+ * LOGGER
+ * Leaves log from inside the tick, so a log call never touches stdio
+ * Every thread formats into its own lock-free ring, a background thread drains the rings and does the writing
+ * A full ring drops the message instead of waiting, the flush thread reports how many were dropped
+ *
+ * Levels below LOG_COMPILED_LEVEL compile away, the rest are filtered at runtime by level and category
+ * Every call site gets at most a few messages through per second, the rest are counted and reported with the next one
+ * Nothing is logged until Logger::Start
+ */
+
+#pragma region defines
+#define LOG_LEVEL_VERBOSE 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+//Lowest level that's compiled in, everything under it costs nothing
+#ifndef LOG_COMPILED_LEVEL
+#ifdef _DEBUG
+#define LOG_COMPILED_LEVEL LOG_LEVEL_VERBOSE
+#else
+#define LOG_COMPILED_LEVEL LOG_LEVEL_INFO
+#endif
+#endif
+#pragma endregion
+
+enum class LogLevel : uint8_t
+{
+	Verbose = LOG_LEVEL_VERBOSE,
+	Info = LOG_LEVEL_INFO,
+	Warning = LOG_LEVEL_WARNING,
+	Error = LOG_LEVEL_ERROR,
+	None = LOG_LEVEL_NONE
+};
+
+//Same tags the messages always had
+enum class LogCategory : uint8_t
+{
+	General,	//[AI]
+	Stats,	//[STATS]
+	House,	//[HOUSE]
+	Item,	//[Item]
+	World,	//[WORLD]
+	Steering,	//[STEERING CHANGE]
+	Count
+};
+
+//Rate limiting state of one call site, every LOG_ macro has its own
+struct LogSite
+{
+	std::atomic<int64_t> WindowStart;	//Milliseconds
+	std::atomic<uint32_t> Count;
+	std::atomic<uint32_t> Suppressed;
+};
+
+class Logger final
+{
+public:
+	//Start the flush thread, messages go to pOutput
+	static void Start(FILE* pOutput = stdout);
+	//Write whatever is left and stop the flush thread
+	static void Stop();
+	//Write everything logged so far, from any thread
+	static void Flush();
+
+	static void SetLevel(LogLevel level) { s_Level.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+	static void SetCategoryEnabled(LogCategory category, bool enabled);
+	//Messages per second every call site gets through, 0 doesn't limit
+	static void SetRateLimit(uint32_t messagesPerSecond) { s_RateLimit.store(messagesPerSecond, std::memory_order_relaxed); }
+
+	//Cheap checks first, so a filtered message is only a couple of loads
+	static bool ShouldLog(LogSite& site, LogLevel level, LogCategory category)
+	{
+		if (!s_Running.load(std::memory_order_relaxed))
+			return false;
+		if (static_cast<uint8_t>(level) < s_Level.load(std::memory_order_relaxed))
+			return false;
+		if ((s_Categories.load(std::memory_order_relaxed) & (1u << static_cast<uint32_t>(category))) == 0)
+			return false;
+
+		return Admit(site);
+	}
+
+	//Formats into the ring of the calling thread, use the LOG_ macros instead
+	static void Write(LogSite& site, LogLevel level, LogCategory category, const char* format, ...);
+
+private:
+	static bool Admit(LogSite& site);
+
+	static std::atomic<bool> s_Running;
+	static std::atomic<uint8_t> s_Level;
+	static std::atomic<uint32_t> s_Categories;
+	static std::atomic<uint32_t> s_RateLimit;
+};
+
+#pragma region macros
+#define LOG_AT(level, category, ...) \
+	do \
+	{ \
+		static LogSite s_LogSite; \
+		if (Logger::ShouldLog(s_LogSite, level, category)) \
+			Logger::Write(s_LogSite, level, category, __VA_ARGS__); \
+	} while (0)
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_VERBOSE
+#define LOG_VERBOSE(category, ...) LOG_AT(LogLevel::Verbose, category, __VA_ARGS__)
+#else
+#define LOG_VERBOSE(category, ...) ((void)0)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(category, ...) LOG_AT(LogLevel::Info, category, __VA_ARGS__)
+#else
+#define LOG_INFO(category, ...) ((void)0)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(category, ...) LOG_AT(LogLevel::Warning, category, __VA_ARGS__)
+#else
+#define LOG_WARNING(category, ...) ((void)0)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(category, ...) LOG_AT(LogLevel::Error, category, __VA_ARGS__)
+#else
+#define LOG_ERROR(category, ...) ((void)0)
+#endif
+#pragma endregion
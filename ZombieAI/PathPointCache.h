@@ -0,0 +1,79 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+
+//The last path point a navmesh that only answers one point at a time gave, for hosts that can't plan the whole path themselves
+//The next corner on the way to a goal stays the same while the agent walks straight at it, so it's only asked again when that can have changed
+//Asked again when the goal moved, the agent got to the corner or wandered off the line to it, or it was reused for too long
+class PathPointCache final
+{
+public:
+	//Closer to the corner than this, the navmesh knows the one after it
+	static constexpr float ReachedRadius = 1.5f;
+	//Farther than this from the line it asked on, something pushed the agent off it
+	static constexpr float CorridorWidth = 2.f;
+	//Goal moved by more than this
+	static constexpr float GoalTolerance = 0.5f;
+	//About half a second at 60 frames, a corner the agent can already see past gets cut after at most that long
+	static constexpr uint32_t MaxReuses = 30;
+
+	//Next point to walk to from start on the way to goal, only calls findPoint(goal) when the cached one can't be used
+	template<typename FindPoint>
+	b2Vec2 GetClosestPathPoint(const b2Vec2& start, const b2Vec2& goal, FindPoint findPoint)
+	{
+		if (CanReuse(start, goal))
+		{
+			++m_Reuses;
+			++m_Hits;
+			//Straight at the goal, it follows the goal around without asking again
+			return m_IsGoal ? goal : m_Point;
+		}
+
+		++m_Misses;
+		m_Reuses = 0;
+		m_From = start;
+		m_Goal = goal;
+		m_Point = findPoint(goal);
+		m_IsGoal = m_Point == goal;
+		m_IsValid = true;
+		return m_Point;
+	}
+
+	void Invalidate() { m_IsValid = false; }
+
+	uint64_t GetHits() const { return m_Hits; }
+	uint64_t GetMisses() const { return m_Misses; }
+
+private:
+	bool CanReuse(const b2Vec2& start, const b2Vec2& goal) const
+	{
+		if (!m_IsValid || m_Reuses >= MaxReuses)
+			return false;
+		if ((goal - m_Goal).LengthSquared() > GoalTolerance * GoalTolerance)
+			return false;
+		if (m_IsGoal)
+			return true;
+		if ((m_Point - start).LengthSquared() < ReachedRadius * ReachedRadius)
+			return false;
+		return DistanceToLineSquared(start) <= CorridorWidth * CorridorWidth;
+	}
+
+	float DistanceToLineSquared(const b2Vec2& position) const
+	{
+		const auto line = m_Point - m_From;
+		const auto lengthSquared = line.LengthSquared();
+		auto along = lengthSquared > 0.f ? b2Dot(position - m_From, line) / lengthSquared : 0.f;
+		along = along < 0.f ? 0.f : (along > 1.f ? 1.f : along);
+		return (m_From + along * line - position).LengthSquared();
+	}
+
+	b2Vec2 m_From = b2Vec2_zero;	//Where the agent was when it asked
+	b2Vec2 m_Goal = b2Vec2_zero;
+	b2Vec2 m_Point = b2Vec2_zero;
+	bool m_IsGoal = false;	//Nothing in the way, the point was the goal itself
+	bool m_IsValid = false;
+	uint32_t m_Reuses = 0;
+
+	uint64_t m_Hits = 0;
+	uint64_t m_Misses = 0;
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include "stdafx.h"
+#include "SteeringBehaviours.h"
+
+/*
+ * STANDALONE STEERING PIPELINE
+ * The framework's combined steering pipeline as far as the agent uses it, for a build without the framework
+ * There's no framework navmesh to decompose the goal on and no enemy avoidance:
+ * the agent already gets its path point from its host whenever there's no enemy in view (ZombieAgent::Steer), with enemies it steers straight at its target
+ */
+namespace CombinedSB
+{
+	class Targeter
+	{
+	public:
+		virtual ~Targeter() {}
+		virtual b2Vec2 GetGoal() const = 0;
+	};
+
+	class Decomposer
+	{
+	public:
+		virtual ~Decomposer() {}
+		virtual b2Vec2 DecomposeGoal(const b2Vec2& goal) const = 0;
+	};
+
+	class Constraint
+	{
+	public:
+		virtual ~Constraint() {}
+	};
+
+	class Actuator
+	{
+	public:
+		virtual ~Actuator() {}
+		virtual PluginOutput CalculateSteering(float dt, AgentInfo& agentInfo, const b2Vec2& goal) = 0;
+	};
+
+	class FixedGoalTargeter final : public Targeter
+	{
+	public:
+		b2Vec2 GetGoal() const override { return m_Goal; }
+		b2Vec2& GetGoalRef() { return m_Goal; }
+
+	private:
+		b2Vec2 m_Goal = b2Vec2_zero;
+	};
+
+	//Leaves the goal where it is, there's no navmesh to find the way on
+	class NavMeshDecomposer final : public Decomposer
+	{
+	public:
+		b2Vec2 DecomposeGoal(const b2Vec2& goal) const override { return goal; }
+	};
+
+	//Holds on to what it avoids, but never steers around it
+	class AvoidEnemyConstraint final : public Constraint
+	{
+	public:
+		AvoidEnemyConstraint(vector<b2Vec2>& enemies, vector<HouseInfo>& houses)
+			: m_Enemies(enemies)
+			, m_Houses(houses)
+		{}
+
+	private:
+		vector<b2Vec2>& m_Enemies;
+		vector<HouseInfo>& m_Houses;
+	};
+
+	//Steers at the goal with whatever behaviour it was given
+	class BasicActuator final : public Actuator
+	{
+	public:
+		explicit BasicActuator(SteeringBehaviours::ISteeringBehaviour* pBehaviour) : m_pBehaviour(pBehaviour) {}
+
+		void SetBehaviour(SteeringBehaviours::ISteeringBehaviour* pBehaviour) { m_pBehaviour = pBehaviour; }
+
+		PluginOutput CalculateSteering(float dt, AgentInfo& agentInfo, const b2Vec2& goal) override
+		{
+			if (!m_pBehaviour)
+				return PluginOutput();
+			m_pBehaviour->SetTarget(goal);
+			return m_pBehaviour->CalculateSteering(dt, agentInfo);
+		}
+
+	private:
+		SteeringBehaviours::ISteeringBehaviour* m_pBehaviour;
+	};
+
+	class SteeringPipeline final
+	{
+	public:
+		void SetTargeters(const vector<Targeter*>& targeters) { m_Targeters = targeters; }
+		void SetDecomposers(const vector<Decomposer*>& decomposers) { m_Decomposers = decomposers; }
+		void SetConstraints(const vector<Constraint*>& constraints) { m_Constraints = constraints; }
+		void SetActuator(Actuator* pActuator) { m_pActuator = pActuator; }
+		void SetFallBack(SteeringBehaviours::ISteeringBehaviour* pFallBack) { m_pFallBack = pFallBack; }
+
+		//Goal of the last targeter, decomposed by every decomposer in turn, handed to the actuator
+		PluginOutput CalculateSteering(float dt, AgentInfo& agentInfo)
+		{
+			if (!m_pActuator || m_Targeters.empty())
+				return m_pFallBack ? m_pFallBack->CalculateSteering(dt, agentInfo) : PluginOutput();
+
+			auto goal = m_Targeters.back()->GetGoal();
+			for (auto pDecomposer : m_Decomposers)
+				goal = pDecomposer->DecomposeGoal(goal);
+			return m_pActuator->CalculateSteering(dt, agentInfo, goal);
+		}
+
+	private:
+		vector<Targeter*> m_Targeters;
+		vector<Decomposer*> m_Decomposers;
+		vector<Constraint*> m_Constraints;
+		Actuator* m_pActuator = nullptr;
+		SteeringBehaviours::ISteeringBehaviour* m_pFallBack = nullptr;
+	};
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "stdafx.h"
+#include <cstdint>
+#include "AI/BehaviourTree/SteeringKernels.h"
+
+/*
+ * STANDALONE STEERING BEHAVIOURS
+ * The framework's steering behaviours the agent uses, for a build without the framework
+ * Seek and arrive are the single agent steering kernel, so they steer the same whether they're batched or not
+ */
+namespace SteeringBehaviours
+{
+	class ISteeringBehaviour
+	{
+	public:
+		virtual ~ISteeringBehaviour() {}
+
+		virtual PluginOutput CalculateSteering(float dt, AgentInfo& agentInfo) = 0;
+
+		void SetTarget(const b2Vec2& target) { m_Target = target; }
+
+	protected:
+		b2Vec2 m_Target = b2Vec2_zero;
+	};
+
+	//Straight at the target at full speed
+	class Seek : public ISteeringBehaviour
+	{
+	public:
+		PluginOutput CalculateSteering(float /*dt*/, AgentInfo& agentInfo) override
+		{
+			return Steer(agentInfo, 0.f);
+		}
+
+	protected:
+		PluginOutput Steer(const AgentInfo& agentInfo, float slowRadius) const
+		{
+			PluginOutput output;
+			output.LinearVelocity = SteeringKernels::Arrive(agentInfo.Position, m_Target, agentInfo.MaxLinearSpeed, slowRadius);
+			output.RunMode = agentInfo.RunMode;
+			return output;
+		}
+	};
+
+	//Seek, slowing down inside the slow radius
+	class Arrive : public Seek
+	{
+	public:
+		PluginOutput CalculateSteering(float /*dt*/, AgentInfo& agentInfo) override
+		{
+			return Steer(agentInfo, m_SlowRadius);
+		}
+
+		void SetSlowRadius(float radius) { m_SlowRadius = radius; }
+
+	private:
+		float m_SlowRadius = 1.f;
+	};
+
+	//Seek towards a point that wanders around a circle ahead of the agent
+	class Wander : public Seek
+	{
+	public:
+		PluginOutput CalculateSteering(float /*dt*/, AgentInfo& agentInfo) override
+		{
+			//Every wander has its own generator, so a run doesn't depend on which thread steered which agent first
+			m_Random ^= m_Random << 13;
+			m_Random ^= m_Random >> 17;
+			m_Random ^= m_Random << 5;
+			m_WanderAngle += (static_cast<float>(m_Random) / 4294967295.f - 0.5f) * m_MaxAngleChange;
+			const b2Vec2 heading(cosf(agentInfo.Orientation), sinf(agentInfo.Orientation));
+			const b2Vec2 offset(cosf(m_WanderAngle) * m_Radius, sinf(m_WanderAngle) * m_Radius);
+			m_Target = agentInfo.Position + m_Offset * heading + offset;
+			return Steer(agentInfo, 0.f);
+		}
+
+		void SetWanderRadius(float radius) { m_Radius = radius; }
+
+	private:
+		float m_Offset = 6.f;
+		float m_Radius = 4.f;
+		float m_MaxAngleChange = 0.5f;
+		float m_WanderAngle = 0.f;
+		uint32_t m_Random = 2463534242u;
+	};
+
+	//Seek, turning around while it goes so the field of view sweeps everything around the agent
+	class LookAround : public Seek
+	{
+	public:
+		PluginOutput CalculateSteering(float /*dt*/, AgentInfo& agentInfo) override
+		{
+			auto output = Steer(agentInfo, 0.f);
+			output.AutoOrientate = false;
+			output.AngularVelocity = agentInfo.MaxAngularSpeed;
+			return output;
+		}
+	};
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "stdafx.h"
+#include "Blackboard.h"
+
+//The framework's behaviour tree, for a build without the framework
+//Only what the flat and static trees share with it, the dynamic tree (BEHAVIOURTREE_DYNAMIC) needs the framework
+enum BehaviorState
+{
+	Failure,
+	Success,
+	Running
+};
+
+class BehaviorTree;
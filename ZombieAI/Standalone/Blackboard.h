@@ -0,0 +1,14 @@
+#pragma once
+#include "stdafx.h"
+
+//The framework's blackboard, for a build without the framework
+//AgentBlackboard keeps every entry itself, the string-keyed ones are only declared so its using-declarations resolve, nothing calls them
+class Blackboard
+{
+public:
+	virtual ~Blackboard() {}
+
+	template<typename T> bool AddData(const string& name, T data);
+	template<typename T> bool ChangeData(const string& name, T data);
+	template<typename T> bool GetData(const string& name, T& data);
+};
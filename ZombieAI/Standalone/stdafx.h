@@ -0,0 +1,162 @@
+#pragma once
+/*
+ * STANDALONE
+ * Stands in for the framework's precompiled header when the agent is built without the framework (CMakeLists.txt)
+ * Only what the agent, the headless runner and the tools use: box2d's vector, the info structs the framework hands out and the house and item types it declares
+ * The plugin itself isn't in it, anything that needs one is left out of a standalone build (ZOMBIEAI_STANDALONE)
+ */
+#define ZOMBIEAI_STANDALONE 1
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#pragma region b2Vec2
+//Same members and operators as box2d's, as far as the agent uses them
+struct b2Vec2
+{
+	b2Vec2() {}
+	b2Vec2(float x, float y) : x(x), y(y) {}
+
+	b2Vec2 operator-() const { return b2Vec2(-x, -y); }
+	void operator+=(const b2Vec2& v) { x += v.x; y += v.y; }
+	void operator-=(const b2Vec2& v) { x -= v.x; y -= v.y; }
+	void operator*=(float a) { x *= a; y *= a; }
+
+	float Length() const { return sqrtf(x * x + y * y); }
+	float LengthSquared() const { return x * x + y * y; }
+
+	//Returns the length it had, leaves it alone when it's too short to have a direction
+	float Normalize()
+	{
+		const auto length = Length();
+		if (length < 1.192092896e-07F)
+			return 0.f;
+		const auto inverse = 1.f / length;
+		x *= inverse;
+		y *= inverse;
+		return length;
+	}
+
+	float x, y;
+};
+
+const b2Vec2 b2Vec2_zero(0.f, 0.f);
+
+inline b2Vec2 operator+(const b2Vec2& a, const b2Vec2& b) { return b2Vec2(a.x + b.x, a.y + b.y); }
+inline b2Vec2 operator-(const b2Vec2& a, const b2Vec2& b) { return b2Vec2(a.x - b.x, a.y - b.y); }
+inline b2Vec2 operator*(float s, const b2Vec2& a) { return b2Vec2(s * a.x, s * a.y); }
+//The framework adds these two
+inline b2Vec2 operator*(const b2Vec2& a, float s) { return b2Vec2(a.x * s, a.y * s); }
+inline b2Vec2 operator/(const b2Vec2& a, float s) { return b2Vec2(a.x / s, a.y / s); }
+inline bool operator==(const b2Vec2& a, const b2Vec2& b) { return a.x == b.x && a.y == b.y; }
+inline bool operator!=(const b2Vec2& a, const b2Vec2& b) { return a.x != b.x || a.y != b.y; }
+inline float b2Dot(const b2Vec2& a, const b2Vec2& b) { return a.x * b.x + a.y * b.y; }
+inline b2Vec2 b2Abs(const b2Vec2& a) { return b2Vec2(fabsf(a.x), fabsf(a.y)); }
+//The framework's as well
+inline b2Vec2 abs(const b2Vec2& a) { return b2Abs(a); }
+#pragma endregion
+
+#pragma region Framework
+enum eEntityType
+{
+	ITEM,
+	ENEMY
+};
+
+enum eItemType
+{
+	PISTOL,
+	HEALTH,
+	FOOD,
+	GARBAGE
+};
+
+struct EntityInfo
+{
+	eEntityType Type;
+	b2Vec2 Position;
+	int EntityHash;
+};
+
+struct HouseInfo
+{
+	b2Vec2 Center;
+	b2Vec2 Size;
+};
+
+struct ItemInfo
+{
+	eItemType Type;
+	int ItemHash;
+};
+
+struct WorldInfo
+{
+	b2Vec2 Center;
+	b2Vec2 Dimensions;
+};
+
+struct AgentInfo
+{
+	float Stamina;
+	float Health;
+	float Energy;
+	bool RunMode;
+	float GrabRange;
+	float FOV_Angle;
+	float FOV_Range;
+
+	b2Vec2 LinearVelocity;
+	float AngularVelocity;
+	float CurrentLinearSpeed;
+	b2Vec2 Position;
+	float Orientation;
+	float MaxLinearSpeed;
+	float MaxAngularSpeed;
+	float AgentSize;
+
+	bool Bitten;
+	bool Death;
+};
+
+struct PluginOutput
+{
+	b2Vec2 LinearVelocity = b2Vec2_zero;
+	float AngularVelocity = 0.f;
+	bool AutoOrientate = true;
+	bool RunMode = false;
+};
+#pragma endregion
+
+#pragma region Plugin
+//Declared next to the plugin in the framework project
+struct House
+{
+	House() {}
+	House(const HouseInfo& houseInfo, bool checked) : m_HouseInfo(houseInfo), m_Checked(checked) {}
+
+	HouseInfo m_HouseInfo = {};
+	bool m_Checked = true;
+};
+
+struct TargetItem
+{
+	EntityInfo m_EntityInfo = {};
+	bool m_Valid = false;
+	bool m_Taken = false;
+};
+
+inline bool PointInRectangle(const b2Vec2& point, const b2Vec2& center, const b2Vec2& size)
+{
+	return fabsf(point.x - center.x) <= size.x / 2.f && fabsf(point.y - center.y) <= size.y / 2.f;
+}
+#pragma endregion
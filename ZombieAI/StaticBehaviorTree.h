@@ -0,0 +1,256 @@
+#pragma once
+#include "stdafx.h"
+#include "Blackboard.h"
+#include "BehaviorTree.h"
+#include "AgentBlackboard.h"
+
+/*
+ * STATIC BEHAVIOUR TREE
+ * Same nodes as the dynamic BehaviorTree, composed as templates: Selector<Sequence<Cond<IsHealthCritical>, ...>>
+ * The whole tree is one type, so there are no heap nodes, no virtual calls and every condition and action can be inlined
+ * The only state kept per tree is the child index of every partial sequence and the outcome of every memoized condition
+ */
+namespace StaticTree
+{
+#pragma region LEAVES
+	//Success if the condition holds
+	template<bool(*Condition)(Blackboard*)>
+	struct Cond
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			return Condition(pBlackboard) ? Success : Failure;
+		}
+	};
+
+	//Cond that only calls the condition again once one of the entries in Inputs changed
+	//Expects an AgentBlackboard
+	template<bool(*Condition)(Blackboard*), BlackboardSlotMask Inputs>
+	struct MemoCond
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			const auto version = AgentBlackboard::From(pBlackboard)->GetVersion(Inputs);
+			if (!m_Valid || m_Version != version)
+			{
+				m_Result = Condition(pBlackboard);
+				m_Version = version;
+				m_Valid = true;
+			}
+			return m_Result ? Success : Failure;
+		}
+
+		uint64_t m_Version = 0;
+		bool m_Result = false;
+		bool m_Valid = false;
+	};
+
+	template<BehaviorState(*Fn)(Blackboard*)>
+	struct Action
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			return Fn(pBlackboard);
+		}
+	};
+
+	//Swaps success and failure, running stays running
+	template<BehaviorState(*Fn)(Blackboard*)>
+	struct ActionInverse
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			switch (Fn(pBlackboard))
+			{
+			case Success:
+				return Failure;
+			case Failure:
+				return Success;
+			default:
+				return Running;
+			}
+		}
+	};
+#pragma endregion
+
+#pragma region CHILDREN
+	//Children of a composite, ticked in order
+	template<typename... Children>
+	struct ChildList;
+
+	template<>
+	struct ChildList<>
+	{
+		static const size_t Count = 0;
+
+		template<BehaviorState ContinueOn, BehaviorState Exhausted>
+		BehaviorState TickWhile(Blackboard*)
+		{
+			return Exhausted;
+		}
+
+		BehaviorState TickAt(Blackboard*, size_t, size_t)
+		{
+			return Success;
+		}
+
+		void TickAll(Blackboard*, bool&) {}
+	};
+
+	template<typename Head, typename... Tail>
+	struct ChildList<Head, Tail...>
+	{
+		static const size_t Count = 1 + sizeof...(Tail);
+
+		//Ticks the children in order as long as they return ContinueOn
+		//Returns what the first other child returned, or Exhausted if they all returned ContinueOn
+		template<BehaviorState ContinueOn, BehaviorState Exhausted>
+		BehaviorState TickWhile(Blackboard* pBlackboard)
+		{
+			const auto state = m_Head.Tick(pBlackboard);
+			if (state != ContinueOn)
+				return state;
+
+			return m_Tail.template TickWhile<ContinueOn, Exhausted>(pBlackboard);
+		}
+
+		//Ticks only the child at index target
+		BehaviorState TickAt(Blackboard* pBlackboard, size_t target, size_t index)
+		{
+			if (index == target)
+				return m_Head.Tick(pBlackboard);
+
+			return m_Tail.TickAt(pBlackboard, target, index + 1);
+		}
+
+		//Ticks every child, whatever they return
+		void TickAll(Blackboard* pBlackboard, bool& anySuccess)
+		{
+			if (m_Head.Tick(pBlackboard) == Success)
+				anySuccess = true;
+
+			m_Tail.TickAll(pBlackboard, anySuccess);
+		}
+
+		Head m_Head;
+		ChildList<Tail...> m_Tail;
+	};
+#pragma endregion
+
+#pragma region COMPOSITES
+	//First child that doesn't fail
+	template<typename... Children>
+	struct Selector
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			return m_Children.template TickWhile<Failure, Failure>(pBlackboard);
+		}
+
+		ChildList<Children...> m_Children;
+	};
+
+	//Every child in order, stops at the first one that doesn't succeed
+	template<typename... Children>
+	struct Sequence
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			return m_Children.template TickWhile<Success, Success>(pBlackboard);
+		}
+
+		ChildList<Children...> m_Children;
+	};
+
+	//Sequence that remembers where it was, one child per tick
+	//Running while it's working through its children, starts over when a child fails
+	template<typename... Children>
+	struct PartialSequence
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			//Went through every child last tick
+			if (m_CurrentIndex >= ChildList<Children...>::Count)
+			{
+				m_CurrentIndex = 0;
+				return Success;
+			}
+
+			switch (m_Children.TickAt(pBlackboard, m_CurrentIndex, 0))
+			{
+			case Failure:
+				m_CurrentIndex = 0;
+				return Failure;
+			case Success:
+				++m_CurrentIndex;
+				return Running;
+			default:
+				return Running;
+			}
+		}
+
+		ChildList<Children...> m_Children;
+		size_t m_CurrentIndex = 0;
+	};
+
+	//Runs its children as a sequence, but always succeeds
+	template<typename... Children>
+	struct AlwaysTrue
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			m_Children.template TickWhile<Success, Success>(pBlackboard);
+			return Success;
+		}
+
+		ChildList<Children...> m_Children;
+	};
+
+	//Runs its children as a sequence, running counts as success
+	template<typename... Children>
+	struct RunningIsGood
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			const auto state = m_Children.template TickWhile<Success, Success>(pBlackboard);
+			return state == Running ? Success : state;
+		}
+
+		ChildList<Children...> m_Children;
+	};
+
+	//Ticks every child, succeeds if any of them did
+	template<typename... Children>
+	struct DoAll
+	{
+		BehaviorState Tick(Blackboard* pBlackboard)
+		{
+			bool anySuccess = false;
+			m_Children.TickAll(pBlackboard, anySuccess);
+			return anySuccess ? Success : Failure;
+		}
+
+		ChildList<Children...> m_Children;
+	};
+#pragma endregion
+
+	//Root of a static tree, ticked once per update like BehaviorTree::Update
+	template<typename Root>
+	class BehaviorTree final
+	{
+	public:
+		void Update(Blackboard* pBlackboard)
+		{
+			m_Root.Tick(pBlackboard);
+		}
+
+		//Forget the state of every partial sequence
+		void Reset()
+		{
+			m_Root = Root();
+		}
+
+	private:
+		Root m_Root;
+	};
+}
@@ -0,0 +1,124 @@
+#include "stdafx.h"
+#include "SteeringKernels.h"
+
+#include <cfloat>
+
+#pragma region defines
+//Widest instruction set the compiler was allowed to use
+#if defined(__AVX512F__)
+#define STEERING_AVX512 1
+#elif defined(__AVX2__)
+#define STEERING_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STEERING_SSE2 1
+#endif
+
+#if STEERING_AVX512 || STEERING_AVX2
+#include <immintrin.h>
+#elif STEERING_SSE2
+#include <emmintrin.h>
+#endif
+#pragma endregion
+
+namespace
+{
+	//Closer than this counts as being on the target, same as b2Vec2::Normalize
+	const float OnTarget = FLT_EPSILON;
+}
+
+b2Vec2 SteeringKernels::Arrive(const b2Vec2& position, const b2Vec2& target, float maxSpeed, float slowRadius)
+{
+	const auto dx = target.x - position.x;
+	const auto dy = target.y - position.y;
+	const auto distance = sqrtf(dx * dx + dy * dy);
+	if (!(distance >= OnTarget))
+		return b2Vec2(0.f, 0.f);
+
+	//Dividing by a slow radius of 0 gives infinity, which is full speed
+	const auto ratio = distance / slowRadius;
+	const auto speed = maxSpeed * (ratio < 1.f ? ratio : 1.f);
+	const auto scale = speed / distance;
+	return b2Vec2(dx * scale, dy * scale);
+}
+
+void SteeringKernels::Arrive(SteeringBatch& batch, size_t begin, size_t end)
+{
+	const auto pPositionX = batch.PositionX.data();
+	const auto pPositionY = batch.PositionY.data();
+	const auto pTargetX = batch.TargetX.data();
+	const auto pTargetY = batch.TargetY.data();
+	const auto pMaxSpeed = batch.MaxSpeed.data();
+	const auto pSlowRadius = batch.SlowRadius.data();
+	auto pLinearX = batch.LinearX.data();
+	auto pLinearY = batch.LinearY.data();
+
+#if STEERING_AVX512
+	const auto one = _mm512_set1_ps(1.f);
+	const auto onTarget = _mm512_set1_ps(OnTarget);
+	for (auto i = begin; i < end; i += 16)
+	{
+		const auto dx = _mm512_sub_ps(_mm512_loadu_ps(pTargetX + i), _mm512_loadu_ps(pPositionX + i));
+		const auto dy = _mm512_sub_ps(_mm512_loadu_ps(pTargetY + i), _mm512_loadu_ps(pPositionY + i));
+		const auto distance = _mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)));
+		const auto moving = _mm512_cmp_ps_mask(distance, onTarget, _CMP_GE_OQ);
+
+		const auto ratio = _mm512_div_ps(distance, _mm512_loadu_ps(pSlowRadius + i));
+		const auto speed = _mm512_mul_ps(_mm512_loadu_ps(pMaxSpeed + i), _mm512_min_ps(ratio, one));
+		const auto scale = _mm512_div_ps(speed, distance);
+		_mm512_storeu_ps(pLinearX + i, _mm512_maskz_mov_ps(moving, _mm512_mul_ps(dx, scale)));
+		_mm512_storeu_ps(pLinearY + i, _mm512_maskz_mov_ps(moving, _mm512_mul_ps(dy, scale)));
+	}
+#elif STEERING_AVX2
+	const auto one = _mm256_set1_ps(1.f);
+	const auto onTarget = _mm256_set1_ps(OnTarget);
+	for (auto i = begin; i < end; i += 8)
+	{
+		const auto dx = _mm256_sub_ps(_mm256_loadu_ps(pTargetX + i), _mm256_loadu_ps(pPositionX + i));
+		const auto dy = _mm256_sub_ps(_mm256_loadu_ps(pTargetY + i), _mm256_loadu_ps(pPositionY + i));
+		const auto distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+		const auto moving = _mm256_cmp_ps(distance, onTarget, _CMP_GE_OQ);
+
+		const auto ratio = _mm256_div_ps(distance, _mm256_loadu_ps(pSlowRadius + i));
+		const auto speed = _mm256_mul_ps(_mm256_loadu_ps(pMaxSpeed + i), _mm256_min_ps(ratio, one));
+		const auto scale = _mm256_div_ps(speed, distance);
+		_mm256_storeu_ps(pLinearX + i, _mm256_and_ps(moving, _mm256_mul_ps(dx, scale)));
+		_mm256_storeu_ps(pLinearY + i, _mm256_and_ps(moving, _mm256_mul_ps(dy, scale)));
+	}
+#elif STEERING_SSE2
+	const auto one = _mm_set1_ps(1.f);
+	const auto onTarget = _mm_set1_ps(OnTarget);
+	for (auto i = begin; i < end; i += 4)
+	{
+		const auto dx = _mm_sub_ps(_mm_loadu_ps(pTargetX + i), _mm_loadu_ps(pPositionX + i));
+		const auto dy = _mm_sub_ps(_mm_loadu_ps(pTargetY + i), _mm_loadu_ps(pPositionY + i));
+		const auto distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+		const auto moving = _mm_cmpge_ps(distance, onTarget);
+
+		const auto ratio = _mm_div_ps(distance, _mm_loadu_ps(pSlowRadius + i));
+		const auto speed = _mm_mul_ps(_mm_loadu_ps(pMaxSpeed + i), _mm_min_ps(ratio, one));
+		const auto scale = _mm_div_ps(speed, distance);
+		_mm_storeu_ps(pLinearX + i, _mm_and_ps(moving, _mm_mul_ps(dx, scale)));
+		_mm_storeu_ps(pLinearY + i, _mm_and_ps(moving, _mm_mul_ps(dy, scale)));
+	}
+#else
+	for (auto i = begin; i < end; ++i)
+	{
+		const auto linear = Arrive(b2Vec2(pPositionX[i], pPositionY[i]), b2Vec2(pTargetX[i], pTargetY[i]), pMaxSpeed[i], pSlowRadius[i]);
+		pLinearX[i] = linear.x;
+		pLinearY[i] = linear.y;
+	}
+#endif
+}
+
+const char* SteeringKernels::InstructionSet()
+{
+#if STEERING_AVX512
+	return "AVX-512";
+#elif STEERING_AVX2
+	return "AVX2";
+#elif STEERING_SSE2
+	return "SSE2";
+#else
+	return "Scalar";
+#endif
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "stdafx.h"
+
+/*
+ * STEERING KERNELS
+ * Seek and arrive for a whole batch of agents at once, on one array per field
+ * Sixteen agents per instruction with AVX-512, eight with AVX2, four with SSE2, one at a time without any of them
+ * Every path does the same operations in the same order, without approximations, so they all give the same bits
+ * That holds as long as the compiler doesn't fuse the multiplies and adds of the scalar path (/fp:precise, -ffp-contract=off)
+ * Tools/SteeringKernelCheck compares them bit for bit
+ *
+ * Seek is arrive without a slow radius, one kernel does both
+ * Wander is a seek towards a random point, picking that point stays with the agent and the seek can be batched
+ */
+
+#pragma region BATCH
+//Input and output of every agent in a batch, one array per field
+//The arrays are padded up to a whole number of lanes, so the kernels never need a loop for the last few agents
+struct SteeringBatch
+{
+	static const size_t Lanes = 16;	//Widest the kernels go, every size is padded up to a multiple of this
+
+	//Input
+	vector<float> PositionX;
+	vector<float> PositionY;
+	vector<float> TargetX;
+	vector<float> TargetY;
+	vector<float> MaxSpeed;
+	vector<float> SlowRadius;	//0 seeks at full speed right up to the target
+
+	//Output
+	vector<float> LinearX;
+	vector<float> LinearY;
+
+	size_t Size() const { return m_Size; }
+
+	//Room for size agents, the padding lanes stand still
+	void Resize(size_t size)
+	{
+		m_Size = size;
+		const auto padded = (size + Lanes - 1) / Lanes * Lanes;
+		for (auto pArray : { &PositionX, &PositionY, &TargetX, &TargetY, &MaxSpeed, &SlowRadius, &LinearX, &LinearY })
+			pArray->assign(padded, 0.f);
+	}
+
+	void Set(size_t index, const b2Vec2& position, const b2Vec2& target, float maxSpeed, float slowRadius)
+	{
+		PositionX[index] = position.x;
+		PositionY[index] = position.y;
+		TargetX[index] = target.x;
+		TargetY[index] = target.y;
+		MaxSpeed[index] = maxSpeed;
+		SlowRadius[index] = slowRadius;
+	}
+
+	b2Vec2 GetLinear(size_t index) const { return b2Vec2(LinearX[index], LinearY[index]); }
+
+private:
+	size_t m_Size = 0;
+};
+#pragma endregion
+
+#pragma region KERNELS
+namespace SteeringKernels
+{
+	//Linear velocity of every agent from begin up to end, begin has to be a multiple of SteeringBatch::Lanes
+	//Straight at the target at full speed, slowing down linearly inside the slow radius, standing still on the target
+	void Arrive(SteeringBatch& batch, size_t begin, size_t end);
+
+	//Same for a single agent, what every lane of the batched kernel works out
+	b2Vec2 Arrive(const b2Vec2& position, const b2Vec2& target, float maxSpeed, float slowRadius);
+
+	//Instruction set Arrive was compiled for
+	const char* InstructionSet();
+}
+#pragma endregion
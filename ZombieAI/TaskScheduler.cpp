@@ -0,0 +1,138 @@
+#include "stdafx.h"
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler(size_t threadCount)
+	: m_RemainingChunks(0)
+{
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (size_t i = 0; i < threadCount; ++i)
+		m_Queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+
+	//The caller is the first thread, start the others
+	for (size_t i = 1; i < threadCount; ++i)
+		m_Threads.push_back(std::thread(&TaskScheduler::WorkerLoop, this, i));
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+	}
+	m_WorkAvailable.notify_all();
+
+	for (auto& thread : m_Threads)
+		thread.join();
+}
+
+void TaskScheduler::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn)
+{
+	if (count == 0)
+		return;
+
+	grainSize = std::max<size_t>(grainSize, 1);
+	const auto chunkCount = (count + grainSize - 1) / grainSize;
+
+	//Not worth waking anyone
+	if (chunkCount == 1 || m_Queues.size() == 1)
+	{
+		fn(0, count);
+		return;
+	}
+
+	m_pJob = &fn;
+	m_RemainingChunks = chunkCount;
+
+	//Hand out neighbouring chunks to the same queue, so every thread starts on one block of agents
+	const auto queueCount = m_Queues.size();
+	for (size_t queue = 0; queue < queueCount; ++queue)
+	{
+		const auto firstChunk = chunkCount * queue / queueCount;
+		const auto endChunk = chunkCount * (queue + 1) / queueCount;
+
+		std::lock_guard<std::mutex> lock(m_Queues[queue]->Mutex);
+		for (auto chunk = firstChunk; chunk < endChunk; ++chunk)
+			m_Queues[queue]->Chunks.push_back({ chunk * grainSize, std::min(count, (chunk + 1) * grainSize) });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		++m_Generation;
+	}
+	m_WorkAvailable.notify_all();
+
+	//Work along until there's nothing left to take, then wait for the chunks still running elsewhere
+	while (RunOne(0)) {}
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_WorkDone.wait(lock, [this]() { return m_RemainingChunks == 0; });
+	m_pJob = nullptr;
+}
+
+void TaskScheduler::WorkerLoop(size_t queueIndex)
+{
+	size_t generation = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkAvailable.wait(lock, [&]() { return m_Quit || m_Generation != generation; });
+			if (m_Quit)
+				return;
+
+			generation = m_Generation;
+		}
+
+		while (RunOne(queueIndex)) {}
+	}
+}
+
+bool TaskScheduler::RunOne(size_t queueIndex)
+{
+	Chunk chunk;
+	if (!Pop(queueIndex, chunk) && !Steal(queueIndex, chunk))
+		return false;
+
+	(*m_pJob)(chunk.Begin, chunk.End);
+
+	//Last chunk of the loop, let the caller go
+	if (--m_RemainingChunks == 0)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_WorkDone.notify_all();
+	}
+	return true;
+}
+
+bool TaskScheduler::Pop(size_t queueIndex, Chunk& chunk)
+{
+	auto& queue = *m_Queues[queueIndex];
+	std::lock_guard<std::mutex> lock(queue.Mutex);
+	if (queue.Chunks.empty())
+		return false;
+
+	chunk = queue.Chunks.back();
+	queue.Chunks.pop_back();
+	return true;
+}
+
+bool TaskScheduler::Steal(size_t queueIndex, Chunk& chunk)
+{
+	//Start at our neighbour, so thieves don't all go for the same queue
+	const auto queueCount = m_Queues.size();
+	for (size_t offset = 1; offset < queueCount; ++offset)
+	{
+		auto& queue = *m_Queues[(queueIndex + offset) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (queue.Chunks.empty())
+			continue;
+
+		chunk = queue.Chunks.front();
+		queue.Chunks.pop_front();
+		return true;
+	}
+	return false;
+}
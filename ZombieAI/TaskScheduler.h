@@ -0,0 +1,68 @@
+#pragma once
+#include "stdafx.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*
+ * TASK SCHEDULER
+ * Spreads a loop over every core, each worker has its own queue of chunks and steals from the others when it runs dry
+ * The chunks only depend on the loop count and the grain size, never on the number of threads
+ * So as long as an iteration only touches its own data, the result is the same on 1 core or 32
+ */
+class TaskScheduler final
+{
+public:
+	//threadCount includes the thread calling ParallelFor, 0 picks one per core
+	explicit TaskScheduler(size_t threadCount = 0);
+	~TaskScheduler();
+
+	TaskScheduler(const TaskScheduler&) = delete;
+	TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+	//Runs fn(begin, end) over [0, count) in chunks of grainSize, returns once every chunk is done
+	//The calling thread works along, don't call ParallelFor from inside fn
+	void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& fn);
+
+	size_t ThreadCount() const { return m_Queues.size(); }
+
+private:
+	struct Chunk
+	{
+		size_t Begin;
+		size_t End;
+	};
+
+	//Owner takes from the back, thieves from the front
+	struct WorkQueue
+	{
+		std::mutex Mutex;
+		std::deque<Chunk> Chunks;
+	};
+
+	void WorkerLoop(size_t queueIndex);
+
+	//Runs one chunk, from our own queue if there's one, stolen otherwise
+	//Returns false if there was nothing left anywhere
+	bool RunOne(size_t queueIndex);
+	bool Pop(size_t queueIndex, Chunk& chunk);
+	bool Steal(size_t queueIndex, Chunk& chunk);
+
+	vector<std::thread> m_Threads;
+	vector<std::unique_ptr<WorkQueue>> m_Queues;	//The caller uses the first queue, every worker one after it
+
+	//Current loop
+	const std::function<void(size_t, size_t)>* m_pJob = nullptr;
+	std::atomic<size_t> m_RemainingChunks;
+
+	//Waking the workers for a new loop, and the caller when it's done
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	std::condition_variable m_WorkDone;
+	size_t m_Generation = 0;
+	bool m_Quit = false;
+};
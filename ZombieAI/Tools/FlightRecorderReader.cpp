@@ -0,0 +1,100 @@
+#include "stdafx.h"
+#include "AI/BehaviourTree/FlightRecorder.h"
+#include "AI/BehaviourTree/FlatBehaviorTree.h"
+#include "AI/BehaviourTree/ZombieBehaviourTree.h"
+
+#include <cstring>
+
+//Decodes a flight recorder file, one line per frame, oldest first
+//Usage: FlightRecorderReader [file] [--seconds S]
+//Node names come from the tree this tool was built with, they're only shown when its layout matches the recording
+int main(int argc, char* argv[])
+{
+	string path = "FlightRecorder.bin";
+	float seconds = 10.f;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+			seconds = static_cast<float>(atof(argv[++i]));
+		else
+			path = argv[i];
+	}
+
+	auto pFile = fopen(path.c_str(), "rb");
+	if (!pFile)
+	{
+		fprintf(stderr, "Couldn't open %s\n", path.c_str());
+		return 1;
+	}
+
+	FlightRecorderHeader header;
+	if (fread(&header, sizeof(header), 1, pFile) != 1 || header.Magic != FlightRecorderHeader::FileMagic)
+	{
+		fprintf(stderr, "%s isn't a flight recorder file\n", path.c_str());
+		fclose(pFile);
+		return 1;
+	}
+	if (header.Version != FlightRecorderHeader::FileVersion || header.RecordSize != sizeof(FlightRecord))
+	{
+		fprintf(stderr, "%s is version %u with %u byte records, this reader wants version %u with %zu byte records\n",
+			path.c_str(), header.Version, header.RecordSize, FlightRecorderHeader::FileVersion, sizeof(FlightRecord));
+		fclose(pFile);
+		return 1;
+	}
+
+	vector<FlightRecord> records(header.Capacity);
+	const auto read = fread(records.data(), sizeof(FlightRecord), records.size(), pFile);
+	fclose(pFile);
+
+	//Oldest record first, the ring wrapped if more were written than fit
+	const auto count = static_cast<size_t>(std::min<uint64_t>(header.RecordCount, std::min<size_t>(read, header.Capacity)));
+	const auto first = header.RecordCount > header.Capacity ? static_cast<size_t>(header.RecordCount % header.Capacity) : 0;
+	if (count == 0)
+	{
+		printf("No records.\n");
+		return 0;
+	}
+
+	//Only name the nodes when the recording was made with the same tree
+	const auto description = BuildZombieBehaviourTree();
+	const auto names = FlatBehaviorTree::NodeNames(description);
+	const auto namesMatch = FlatBehaviorTree(description).LayoutHash() == header.TreeLayout;
+	if (!namesMatch)
+		printf("Recorded with a different behaviour tree, showing node indices.\n");
+
+	const char* const steering[] = { "None", "Wander", "Seek", "LookAround", "Arrive", "Other" };
+	const auto& last = records[(first + count - 1) % header.Capacity];
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const auto& record = records[(first + i) % header.Capacity];
+		if (record.Time < last.Time - seconds)
+			continue;
+
+		printf("%8llu %8.2fs pos(%.1f, %.1f) hp %.1f en %.1f st %.1f%s%s%s | enemies %u houses %u items %u | target(%.1f, %.1f) %s out(%.1f, %.1f, %.2f)%s |",
+			static_cast<unsigned long long>(record.Frame), record.Time,
+			record.Position[0], record.Position[1], record.Health, record.Energy, record.Stamina,
+			(record.Flags & FlightRunMode) ? " running" : "",
+			(record.Flags & FlightBitten) ? " BITTEN" : "",
+			(record.Flags & FlightDeath) ? " DEAD" : "",
+			record.EnemiesInView, record.KnownHouses, record.KnownItems,
+			record.Target[0], record.Target[1],
+			static_cast<size_t>(record.Steering) < sizeof(steering) / sizeof(steering[0]) ? steering[static_cast<size_t>(record.Steering)] : "?",
+			record.OutputLinearVelocity[0], record.OutputLinearVelocity[1], record.OutputAngularVelocity,
+			(record.Flags & FlightOutputRunMode) ? " run" : "");
+
+		for (size_t depth = 0; depth < record.PathLength; ++depth)
+		{
+			const auto node = record.Path[depth];
+			const auto pSeparator = depth == 0 ? " " : " > ";
+			if (namesMatch && node < names.size())
+				printf("%s%s", pSeparator, names[node]);
+			else
+				printf("%s%u", pSeparator, node);
+		}
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include "HeadlessRunner.h"
+#include "AI/BehaviourTree/Logger.h"
+#include "AI/BehaviourTree/ZombieBehaviourTree.h"
+#include "AI/BehaviourTree/FlatTreeImage.h"
+
+#include <cstring>
+
+//Runs agents headless and reports how fast the simulation goes
+//Usage: HeadlessMain [--agents N] [--threads N] [--seconds S] [--seed N] [--log verbose|info|warning|error] [--batch-steering on|off] [--path-cache on|off]
+//                    [--cluster-size N] [--hierarchy-file path] [--path-threads N] [--frame-budget ms] [--tree-image path]
+//The agents don't log unless asked to, hundreds of them would drown the report
+int main(int argc, char* argv[])
+{
+	HeadlessRunSettings settings;
+	auto logLevel = LogLevel::None;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--agents") == 0)
+			settings.AgentCount = static_cast<size_t>(atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--threads") == 0)
+			settings.ThreadCount = static_cast<size_t>(atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--seconds") == 0)
+			settings.Duration = static_cast<float>(atof(argv[i + 1]));
+		else if (strcmp(argv[i], "--seed") == 0)
+			settings.World.Seed = static_cast<uint32_t>(atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--batch-steering") == 0)
+			settings.BatchSteering = strcmp(argv[i + 1], "on") == 0;
+		else if (strcmp(argv[i], "--path-cache") == 0)
+			settings.World.PathCache = strcmp(argv[i + 1], "on") == 0;
+		else if (strcmp(argv[i], "--cluster-size") == 0)
+			settings.World.ClusterSize = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--hierarchy-file") == 0)
+			settings.World.HierarchyFile = argv[i + 1];
+		else if (strcmp(argv[i], "--path-threads") == 0)
+			settings.PathThreads = static_cast<size_t>(atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--frame-budget") == 0)
+			settings.FrameBudget.Budget = atof(argv[i + 1]) / 1000.0;
+		else if (strcmp(argv[i], "--tree-image") == 0)
+			settings.TreeImageFile = argv[i + 1];
+		else if (strcmp(argv[i], "--log") == 0)
+		{
+			const char* const levels[] = { "verbose", "info", "warning", "error" };
+			for (int level = 0; level < 4; ++level)
+			{
+				if (strcmp(argv[i + 1], levels[level]) == 0)
+					logLevel = static_cast<LogLevel>(level);
+			}
+		}
+		else
+		{
+			printf("Unknown option %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	if (logLevel != LogLevel::None)
+	{
+		Logger::SetLevel(logLevel);
+		Logger::Start();
+	}
+
+	HeadlessRunner runner(settings);
+	const auto stats = runner.Run();
+	Logger::Stop();
+
+	printf("[HEADLESS] %zu agents, %zu threads\n", settings.AgentCount, settings.ThreadCount);
+	if (settings.BatchSteering)
+		printf("[HEADLESS] Batch steering with %s\n", SteeringKernels::InstructionSet());
+	printf("[HEADLESS] %llu frames, %.1f simulated seconds in %.3f wall seconds\n",
+		static_cast<unsigned long long>(stats.Frames), stats.SimulatedSeconds, stats.WallSeconds);
+	printf("[HEADLESS] %.1f simulated seconds per wall second\n", stats.WallSeconds > 0.0 ? stats.SimulatedSeconds / stats.WallSeconds : 0.0);
+	if (!settings.TreeImageFile.empty())
+	{
+		static const char* statusNames[] = { "mapped", "rebuilt", "rebuilt but not saved", "not built" };
+		printf("[HEADLESS] Behaviour tree image %s %s", settings.TreeImageFile.c_str(), statusNames[static_cast<int>(stats.TreeImage)]);
+		if (stats.TreeImage != ZombieTreeImageStatus::Mapped)
+			printf(", the saved one was %s", FlatTreeImage::ErrorName(stats.TreeImageError));
+		printf("\n");
+	}
+	printf("[HEADLESS] %zu deaths, %.1f seconds survived on average\n", stats.Deaths, stats.AverageSurvival);
+	printf("[HEADLESS] Population update %.3f ms on average, %.3f ms p99\n", stats.AverageFrameSeconds * 1000.0, stats.P99FrameSeconds * 1000.0);
+	if (settings.FrameBudget.Budget > 0.0)
+	{
+		const auto agentFrames = static_cast<double>(stats.Frames) * settings.AgentCount;
+		printf("[HEADLESS] Frame budget %.3f ms: %.1f%% of agent frames ticked, %llu starved\n", settings.FrameBudget.Budget * 1000.0,
+			agentFrames > 0.0 ? 100.0 * stats.Ticks / agentFrames : 0.0, static_cast<unsigned long long>(stats.Starved));
+	}
+	if (settings.World.PathCache)
+	{
+		const auto& paths = stats.PathCache;
+		const auto queries = paths.Hits + paths.Misses;
+		printf("[HEADLESS] Path cache: %llu hits, %llu misses (%llu left the corridor, %llu goal moved, %llu refined), %.1f%% hit rate\n",
+			static_cast<unsigned long long>(paths.Hits), static_cast<unsigned long long>(paths.Misses),
+			static_cast<unsigned long long>(paths.LeftCorridor), static_cast<unsigned long long>(paths.GoalMoved),
+			static_cast<unsigned long long>(paths.Refined),
+			queries > 0 ? 100.0 * paths.Hits / queries : 0.0);
+		if (settings.PathThreads > 0)
+		{
+			printf("[HEADLESS] Path service: %zu threads, %llu calls waited on a plan, %llu plans cancelled\n", settings.PathThreads,
+				static_cast<unsigned long long>(paths.Waited), static_cast<unsigned long long>(paths.Cancelled));
+		}
+	}
+	return 0;
+}
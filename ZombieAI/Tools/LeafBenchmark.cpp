@@ -0,0 +1,618 @@
+#include "stdafx.h"
+#include "AI/BehaviourTree/Behaviours.h"
+
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+
+/*
+ * LEAF BENCHMARK
+ * Runs every condition and action of Behaviours.h on its own, on a blackboard that knows 10, 100 and 1000 houses and items
+ * Reports ns/call and allocations/call for every leaf and size, a call too short for the clock to tell apart from no call at all shows as an upper bound (<)
+ * Usage: LeafBenchmark [--iterations N] [--out results.csv] [--baseline results.csv] [--tolerance 1.5]
+ * With a baseline it exits with 1 when a leaf got slower than tolerance times its baseline or allocates more
+ * Only compare against a baseline taken on the same machine
+ * The logger isn't started, so the leaves' log calls only cost the check that turns them away
+ */
+
+#pragma region Allocations
+//Every allocation in the process goes through here, the benchmark only reads the counter around a call
+static std::atomic<size_t> s_Allocations(0);
+
+void* operator new(size_t size)
+{
+	s_Allocations.fetch_add(1, std::memory_order_relaxed);
+	if (auto pMemory = malloc(size ? size : 1))
+		return pMemory;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+void operator delete[](void* pMemory) noexcept
+{
+	free(pMemory);
+}
+void operator delete(void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+#pragma endregion
+
+#pragma region Host
+//Host with a fixed inventory that goes back to how it started before every call
+//Every item it hands out is a healthkit, so PickupItem takes its longest path on a full inventory
+class BenchmarkHost final : public IAgentHost
+{
+public:
+	explicit BenchmarkHost(const WorldInfo& worldInfo)
+		: m_WorldInfo(worldInfo)
+	{
+		const eItemType types[InventoryCapacity] = { HEALTH, HEALTH, FOOD, FOOD, HEALTH };
+		for (int i = 0; i < InventoryCapacity; ++i)
+		{
+			m_StartInventory[i] = {};
+			m_StartInventory[i].Type = types[i];
+			m_StartInventory[i].ItemHash = i + 1;
+		}
+		Reset();
+	}
+
+	void Reset()
+	{
+		for (int i = 0; i < InventoryCapacity; ++i)
+		{
+			m_Inventory[i] = m_StartInventory[i];
+			m_SlotUsed[i] = i < InventoryCapacity - 1;
+		}
+		m_Changed = false;
+	}
+
+	//Did a leaf change the inventory since the last reset
+	bool IsChanged() const { return m_Changed; }
+
+	void SetAgentInfo(const AgentInfo& agentInfo) { m_AgentInfo = agentInfo; }
+
+	AgentInfo AGENT_GetInfo() override { return m_AgentInfo; }
+	WorldInfo WORLD_GetInfo() override { return m_WorldInfo; }
+
+	vector<HouseInfo> FOV_GetHouses() override { return {}; }
+	vector<EntityInfo> FOV_GetEntities() override { return {}; }
+	void FOV_FillHouses(FrameVector<HouseInfo>&) override {}
+	void FOV_FillEntities(FrameVector<EntityInfo>&) override {}
+
+	int INVENTORY_GetCapacity() override { return InventoryCapacity; }
+	bool INVENTORY_GetItem(int slot, ItemInfo& item) override
+	{
+		if (!IsUsed(slot))
+			return false;
+		item = m_Inventory[slot];
+		return true;
+	}
+	bool INVENTORY_AddItem(int slot, ItemInfo item) override
+	{
+		if (slot < 0 || slot >= InventoryCapacity || m_SlotUsed[slot])
+			return false;
+		m_Inventory[slot] = item;
+		m_SlotUsed[slot] = true;
+		m_Changed = true;
+		return true;
+	}
+	bool INVENTORY_UseItem(int slot) override { return IsUsed(slot); }
+	bool INVENTORY_RemoveItem(int slot) override
+	{
+		if (!IsUsed(slot))
+			return false;
+		m_SlotUsed[slot] = false;
+		m_Changed = true;
+		return true;
+	}
+
+	bool ITEM_Grab(EntityInfo entity, ItemInfo& item) override
+	{
+		item = {};
+		item.Type = HEALTH;
+		item.ItemHash = entity.EntityHash;
+		return true;
+	}
+	bool ITEM_GetMetadata(ItemInfo item, const string&, int& value) override
+	{
+		value = 1 + item.ItemHash % 4;
+		return true;
+	}
+
+	b2Vec2 NAVMESH_GetClosestPathPoint(b2Vec2 goal) override { return goal; }
+
+private:
+	static const int InventoryCapacity = 5;
+
+	bool IsUsed(int slot) const { return slot >= 0 && slot < InventoryCapacity && m_SlotUsed[slot]; }
+
+	WorldInfo m_WorldInfo;
+	AgentInfo m_AgentInfo = {};
+	ItemInfo m_StartInventory[InventoryCapacity];
+	ItemInfo m_Inventory[InventoryCapacity];
+	bool m_SlotUsed[InventoryCapacity] = {};
+	bool m_Changed = false;
+};
+#pragma endregion
+
+#pragma region Fixture
+//Blackboard of an agent that's hurt, hungry and standing in the first of its known houses, next to an item
+//The snapshot holds the same data, every slot a leaf changes is copied back from it before the next call
+struct Fixture
+{
+	Fixture(size_t size, BenchmarkHost* pHost, const WorldInfo* pWorldInfo)
+		: pHost(pHost)
+	{
+		Fill(&Board, size, pWorldInfo);
+		Fill(&Snapshot, size, pWorldInfo);
+		Board.ClearChanges();
+	}
+
+	//Put everything the leaf changed back, outside of the measured part
+	void Restore()
+	{
+		pHost->Reset();
+
+		const auto changes = Board.GetChanges();
+#define RESTORE_SLOT(name, type) \
+		if (changes & SlotMask(Keys::name)) \
+			Board.ChangeData(Keys::name, Snapshot.View(Keys::name));
+		AGENT_BLACKBOARD_ENTRIES(RESTORE_SLOT)
+#undef RESTORE_SLOT
+		Board.ClearChanges();
+	}
+
+	AgentBlackboard Board;
+	AgentBlackboard Snapshot;
+	BenchmarkHost* pHost;
+
+	//Steering behaviours aren't ticked by the leaves, they're only handed around
+	SteeringBehaviours::Seek Seek;
+	SteeringBehaviours::LookAround LookAround;
+	SteeringBehaviours::Wander Wander;
+	SteeringBehaviours::Arrive Arrive;
+
+private:
+	void Fill(AgentBlackboard* pBoard, size_t size, const WorldInfo* pWorldInfo)
+	{
+		const float spacing = 40.f;
+		const auto columns = static_cast<size_t>(ceil(sqrt(static_cast<float>(size))));
+		const auto origin = pWorldInfo->Center - 0.5f * pWorldInfo->Dimensions + b2Vec2(spacing, spacing);
+
+		//Houses on a grid, all unchecked
+		HouseRegistry houses;
+		for (size_t i = 0; i < size; ++i)
+		{
+			HouseInfo house = {};
+			house.Center = origin + b2Vec2(spacing * (i % columns), spacing * (i / columns));
+			house.Size = b2Vec2(20.f, 20.f);
+			houses.Add(house);
+		}
+		const auto firstHouse = *houses.begin();
+
+		//One item in every house, the one next to us is the newest
+		ItemStore items;
+		for (size_t i = size; i-- > 0;)
+		{
+			EntityInfo item = {};
+			item.Type = ITEM;
+			item.Position = origin + b2Vec2(spacing * (i % columns) + 1.5f, spacing * (i / columns) + 1.f);
+			item.EntityHash = static_cast<int>(i) + 1;
+			items.Add(item);
+		}
+
+		TargetItem targetItem;
+		targetItem.m_EntityInfo = items.Newest();
+		targetItem.m_Valid = true;
+
+		AgentInfo agentInfo = {};
+		agentInfo.Health = 2.f;
+		agentInfo.Energy = 3.f;
+		agentInfo.Stamina = 10.f;
+		agentInfo.GrabRange = 2.f;
+		agentInfo.FOV_Angle = 1.57f;
+		agentInfo.FOV_Range = 20.f;
+		agentInfo.MaxLinearSpeed = 5.f;
+		agentInfo.MaxAngularSpeed = 3.14f;
+		agentInfo.AgentSize = 1.f;
+		agentInfo.Position = firstHouse.m_HouseInfo.Center + b2Vec2(1.f, 1.f);
+		pHost->SetAgentInfo(agentInfo);
+
+		pBoard->ChangeData(Keys::Host, static_cast<IAgentHost*>(pHost));
+		pBoard->ChangeData(Keys::WanderBehaviour, &Wander);
+		pBoard->ChangeData(Keys::SeekBehaviour, &Seek);
+		pBoard->ChangeData(Keys::LookAroundBehaviour, &LookAround);
+		pBoard->ChangeData(Keys::ArriveBehaviour, &Arrive);
+		pBoard->ChangeData(Keys::CurrentBehaviour, static_cast<SteeringBehaviours::ISteeringBehaviour*>(&Seek));
+		pBoard->ChangeData(Keys::Target, firstHouse.m_HouseInfo.Center);
+		pBoard->ChangeData(Keys::WorldInfo, pWorldInfo);
+		pBoard->ChangeData(Keys::AgentInfo, agentInfo);
+		pBoard->ChangeData(Keys::Vitals, MeasureVitals(agentInfo.Health, agentInfo.Energy));
+		pBoard->ChangeData(Keys::LastDiscovery, 0.f);
+		pBoard->ChangeData(Keys::CurrentHouse, houses.Find(firstHouse.m_HouseInfo.Center));
+		pBoard->ChangeData(Keys::HouseLocations, std::move(houses));
+		pBoard->ChangeData(Keys::HouseEntrance, firstHouse.m_HouseInfo.Center - b2Vec2(0.f, 10.f));
+		pBoard->ChangeData(Keys::Items, std::move(items));
+		pBoard->ChangeData(Keys::TargetItem, targetItem);
+		pBoard->Borrow(Keys::Inventory)->Sync(pHost);
+		pBoard->ChangeData(Keys::Enemies, vector<EntityInfo>{});
+		pBoard->ChangeData(Keys::EnemySightings, 0u);
+	}
+};
+#pragma endregion
+
+#pragma region Batch
+//Fixtures that don't share anything, so a leaf that changes the board can be called once on each of them in a row
+//Everything is put back outside of the measured part, between two batches
+struct FixtureBatch
+{
+	static const size_t Size = 32;
+
+	FixtureBatch(size_t size, const WorldInfo* pWorldInfo)
+	{
+		for (size_t i = 0; i < Size; ++i)
+		{
+			Hosts.emplace_back(new BenchmarkHost(*pWorldInfo));
+			Fixtures.emplace_back(new Fixture(size, Hosts.back().get(), pWorldInfo));
+		}
+	}
+
+	void Restore()
+	{
+		for (auto& pFixture : Fixtures)
+			pFixture->Restore();
+	}
+
+	vector<std::unique_ptr<BenchmarkHost>> Hosts;
+	vector<std::unique_ptr<Fixture>> Fixtures;
+};
+#pragma endregion
+
+#pragma region Leaves
+struct LeafCase
+{
+	const char* Name;
+	bool(*Condition)(Blackboard*);
+	BehaviorState(*Action)(Blackboard*);
+};
+
+#define LEAF_CONDITION(name) { #name, &name, nullptr }
+#define LEAF_ACTION(name) { #name, nullptr, &name }
+
+static const LeafCase s_Leaves[] =
+{
+	//Conditions
+	LEAF_CONDITION(IsHealthCritical),
+	LEAF_CONDITION(IsEnergyCritical),
+	LEAF_CONDITION(NotMaxHealth),
+	LEAF_CONDITION(NotMaxEnergy),
+	LEAF_CONDITION(HasTargetItem),
+	LEAF_CONDITION(HasTargetHouse),
+	LEAF_CONDITION(InsideTargetHouse),
+	LEAF_CONDITION(HouseBigEnough),
+	LEAF_CONDITION(NoDiscoveryInTime),
+
+	//Core stats
+	LEAF_ACTION(UseAnyHealthKit),
+	LEAF_ACTION(UseAnyFood),
+	LEAF_ACTION(UseBestHealthKit),
+	LEAF_ACTION(UseBestFood),
+
+	//Items
+	LEAF_ACTION(SpotNewItem),
+	LEAF_ACTION(SetItemAsTarget),
+	LEAF_ACTION(PickupItem),
+
+	//Houses
+	LEAF_ACTION(SetTargetHouse),
+	LEAF_ACTION(SetHouseAsTarget),
+	LEAF_ACTION(CheckHouseCenter),
+	LEAF_ACTION(CheckTopLeftCorner),
+	LEAF_ACTION(CheckTopRightCorner),
+	LEAF_ACTION(CheckBottomRightCorner),
+	LEAF_ACTION(CheckBottomLeftCorner),
+	LEAF_ACTION(MarkHouseChecked),
+	LEAF_ACTION(LeaveHouse),
+	LEAF_ACTION(CheckWorldTopLeft),
+	LEAF_ACTION(CheckWorldTopRight),
+	LEAF_ACTION(CheckWorldBottomRight),
+	LEAF_ACTION(CheckWorldBottomLeft),
+	LEAF_ACTION(ResetHouses),
+
+	//Movement
+	LEAF_ACTION(StartSprinting),
+	LEAF_ACTION(StopSprinting),
+	LEAF_ACTION(WanderAround),
+	LEAF_ACTION(LookAroundGoToTarget),
+	LEAF_ACTION(GoToTarget),
+	LEAF_ACTION(ArriveAtTarget),
+};
+
+#undef LEAF_CONDITION
+#undef LEAF_ACTION
+
+static const size_t s_Sizes[] = { 10, 100, 1000 };
+#pragma endregion
+
+#pragma region Measuring
+typedef std::chrono::steady_clock Clock;
+
+struct LeafResult
+{
+	double Nanoseconds = 0.0;	//An upper bound when it isn't resolved
+	double Allocations = 0.0;
+	bool Resolved = true;	//Took longer than the clock can tell apart from doing nothing
+};
+
+//What reading the clock twice costs, and the shortest time it can tell apart from that, both in ns
+struct ClockCost
+{
+	double Overhead = 0.0;
+	double Resolution = 0.0;
+};
+
+//Median of many empty timed regions, so one that got interrupted doesn't count
+//The resolution is the smallest step the clock was seen to take, or the overhead when that's more
+static ClockCost MeasureClock()
+{
+	const size_t samples = 10001;
+	vector<double> empty(samples);
+	auto step = DBL_MAX;
+	for (size_t i = 0; i < samples; ++i)
+	{
+		const auto start = Clock::now();
+		const auto end = Clock::now();
+		empty[i] = std::chrono::duration<double, std::nano>(end - start).count();
+		if (empty[i] > 0.0)
+			step = std::min(step, empty[i]);
+	}
+	std::nth_element(empty.begin(), empty.begin() + samples / 2, empty.end());
+
+	ClockCost cost;
+	cost.Overhead = empty[samples / 2];
+	cost.Resolution = std::max(cost.Overhead, step == DBL_MAX ? 1.0 : step);
+	return cost;
+}
+
+static int Call(const LeafCase& leaf, Blackboard* pBlackboard)
+{
+	if (leaf.Condition)
+		return leaf.Condition(pBlackboard) ? 1 : 0;
+	return static_cast<int>(leaf.Action(pBlackboard));
+}
+
+//Best of a few rounds, a round that got interrupted or ran on a cold cache doesn't count
+//Leaves that leave the board and the host as they found them run back to back on one fixture between two clock reads
+//The others are called once on every fixture of the batch between two clock reads, the batch is put back outside of them
+//Every timed region pays for the clock overhead once, that's taken off again
+static LeafResult Measure(const LeafCase& leaf, FixtureBatch& batch, size_t iterations, const ClockCost& clock)
+{
+	const size_t rounds = 8;
+	const auto roundIterations = std::max<size_t>(iterations / rounds, 1);
+	auto& fixture = *batch.Fixtures.front();
+
+	batch.Restore();
+	volatile int sink = Call(leaf, &fixture.Board);
+	const auto pure = fixture.Board.GetChanges() == 0 && !fixture.pHost->IsChanged();
+
+	auto best = DBL_MAX;
+	size_t bestCalls = 1;
+	size_t allocations = 0;
+	size_t calls = 0;
+
+	for (size_t round = 0; round < rounds; ++round)
+	{
+		batch.Restore();
+
+		if (pure)
+		{
+			const auto allocationsBefore = s_Allocations.load(std::memory_order_relaxed);
+			const auto start = Clock::now();
+			for (size_t i = 0; i < roundIterations; ++i)
+				sink += Call(leaf, &fixture.Board);
+			const auto end = Clock::now();
+
+			allocations += s_Allocations.load(std::memory_order_relaxed) - allocationsBefore;
+			calls += roundIterations;
+			const auto elapsed = std::chrono::duration<double, std::nano>(end - start).count() - clock.Overhead;
+			if (elapsed / roundIterations < best / bestCalls)
+			{
+				best = elapsed;
+				bestCalls = roundIterations;
+			}
+			continue;
+		}
+
+		//The fastest batch of the round, every batch is as many calls
+		const auto batches = std::max<size_t>(roundIterations / FixtureBatch::Size, 1);
+		for (size_t b = 0; b < batches; ++b)
+		{
+			batch.Restore();
+
+			const auto allocationsBefore = s_Allocations.load(std::memory_order_relaxed);
+			const auto start = Clock::now();
+			for (auto& pFixture : batch.Fixtures)
+				sink += Call(leaf, &pFixture->Board);
+			const auto end = Clock::now();
+
+			allocations += s_Allocations.load(std::memory_order_relaxed) - allocationsBefore;
+			calls += FixtureBatch::Size;
+			const auto elapsed = std::chrono::duration<double, std::nano>(end - start).count() - clock.Overhead;
+			if (elapsed / FixtureBatch::Size < best / bestCalls)
+			{
+				best = elapsed;
+				bestCalls = FixtureBatch::Size;
+			}
+		}
+	}
+
+	LeafResult result;
+	result.Allocations = static_cast<double>(allocations) / calls;
+	result.Resolved = best >= clock.Resolution;
+	result.Nanoseconds = (result.Resolved ? best : clock.Resolution) / bestCalls;
+	return result;
+}
+#pragma endregion
+
+#pragma region Baseline
+typedef std::map<std::pair<string, size_t>, LeafResult> LeafResults;
+
+//leaf,size,ns,allocations,resolved per line, ns is an upper bound when it isn't resolved
+static void WriteResults(const string& path, const LeafResults& results)
+{
+	std::ofstream file(path);
+	file << "leaf,size,ns,allocations,resolved\n";
+	for (const auto& result : results)
+	{
+		file << result.first.first << ',' << result.first.second << ',' << result.second.Nanoseconds << ',' << result.second.Allocations
+			<< ',' << (result.second.Resolved ? 1 : 0) << '\n';
+	}
+}
+
+static bool ReadResults(const string& path, LeafResults& results)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	string line;
+	std::getline(file, line);
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		string name, size, nanoseconds, allocations;
+		if (!std::getline(stream, name, ',') || !std::getline(stream, size, ',')
+			|| !std::getline(stream, nanoseconds, ',') || !std::getline(stream, allocations, ','))
+			continue;
+
+		//Older baselines don't say, they're taken as resolved
+		string resolved;
+		LeafResult result;
+		result.Nanoseconds = atof(nanoseconds.c_str());
+		result.Allocations = atof(allocations.c_str());
+		result.Resolved = !std::getline(stream, resolved, ',') || atoi(resolved.c_str()) != 0;
+		results[std::make_pair(name, static_cast<size_t>(atoi(size.c_str())))] = result;
+	}
+	return true;
+}
+
+//Returns the number of leaves that regressed
+//An unresolved time is an upper bound, a leaf that got slower than the bound of its baseline still counts
+static int CompareResults(const LeafResults& results, const LeafResults& baseline, double tolerance)
+{
+	//A few nanoseconds of noise on the cheapest leaves isn't a regression
+	const double slack = 10.0;
+
+	int regressions = 0;
+	for (const auto& result : results)
+	{
+		auto it = baseline.find(result.first);
+		if (it == baseline.end())
+			continue;
+
+		const auto slower = result.second.Nanoseconds > it->second.Nanoseconds * tolerance + slack;
+		const auto allocates = result.second.Allocations > it->second.Allocations + 0.01;
+		if (!slower && !allocates)
+			continue;
+
+		fprintf(stderr, "[REGRESSION] %s (%zu): %.1f ns, %.2f allocs, baseline %.1f ns, %.2f allocs\n",
+			result.first.first.c_str(), result.first.second,
+			result.second.Nanoseconds, result.second.Allocations,
+			it->second.Nanoseconds, it->second.Allocations);
+		++regressions;
+	}
+	return regressions;
+}
+#pragma endregion
+
+int main(int argc, char* argv[])
+{
+	size_t iterations = 20000;
+	string outPath, baselinePath;
+	double tolerance = 1.5;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--iterations") == 0)
+			iterations = std::max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--out") == 0)
+			outPath = argv[i + 1];
+		else if (strcmp(argv[i], "--baseline") == 0)
+			baselinePath = argv[i + 1];
+		else if (strcmp(argv[i], "--tolerance") == 0)
+			tolerance = atof(argv[i + 1]);
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	WorldInfo worldInfo = {};
+	worldInfo.Center = b2Vec2_zero;
+	worldInfo.Dimensions = b2Vec2(2000.f, 2000.f);
+	const auto clock = MeasureClock();
+	printf("Clock: %.1f ns overhead, %.1f ns resolution\n", clock.Overhead, clock.Resolution);
+
+	//Built once for every leaf, each leaf puts them back the way it found them
+	vector<std::unique_ptr<FixtureBatch>> batches;
+	for (auto size : s_Sizes)
+		batches.emplace_back(new FixtureBatch(size, &worldInfo));
+
+	LeafResults results;
+
+	printf("%-24s", "ns/call (allocs/call)");
+	for (auto size : s_Sizes)
+		printf("%20zu", size);
+	printf("\n");
+
+	for (const auto& leaf : s_Leaves)
+	{
+		printf("%-24s", leaf.Name);
+		for (size_t i = 0; i < batches.size(); ++i)
+		{
+			const auto size = s_Sizes[i];
+			const auto result = Measure(leaf, *batches[i], iterations, clock);
+			results[std::make_pair(string(leaf.Name), size)] = result;
+
+			char cell[32];
+			snprintf(cell, sizeof(cell), "%s%.1f (%.2f)", result.Resolved ? "" : "<", result.Nanoseconds, result.Allocations);
+			printf("%20s", cell);
+		}
+		printf("\n");
+	}
+
+	if (!outPath.empty())
+		WriteResults(outPath, results);
+
+	if (!baselinePath.empty())
+	{
+		LeafResults baseline;
+		if (!ReadResults(baselinePath, baseline))
+		{
+			fprintf(stderr, "Couldn't read baseline %s\n", baselinePath.c_str());
+			return 1;
+		}
+		if (CompareResults(results, baseline, tolerance) > 0)
+			return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "stdafx.h"
+#include "AI/BehaviourTree/SteeringKernels.h"
+
+#include <cfloat>
+#include <cstring>
+#include <random>
+
+//Checks the batched steering kernels give the same bits as the single agent one
+//Seek and arrive over random agents, for every batch size up to a few lanes past the widest, so every tail length gets its turn
+//Usage: SteeringKernelCheck [--rounds N] [--seed S]
+//Exits with 1 on the first mismatch, build it with the same floating point flags as the plugin
+
+namespace
+{
+	bool SameBits(float a, float b)
+	{
+		return memcmp(&a, &b, sizeof(float)) == 0;
+	}
+
+	//Mostly anywhere in the world, now and then right on or next to the target, where the kernels stop moving
+	b2Vec2 RandomTarget(std::mt19937& random, const b2Vec2& position)
+	{
+		std::uniform_real_distribution<float> world(-500.f, 500.f);
+		switch (random() % 8)
+		{
+		case 0:
+			return position;
+		case 1:
+		{
+			std::uniform_real_distribution<float> close(-2.f * FLT_EPSILON, 2.f * FLT_EPSILON);
+			return b2Vec2(position.x + close(random), position.y + close(random));
+		}
+		case 2:
+		{
+			std::uniform_real_distribution<float> nearby(-5.f, 5.f);
+			return b2Vec2(position.x + nearby(random), position.y + nearby(random));
+		}
+		default:
+			return b2Vec2(world(random), world(random));
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int rounds = 200;
+	uint32_t seed = 1;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--rounds") == 0)
+			rounds = std::max(1, atoi(argv[i + 1]));
+		else if (strcmp(argv[i], "--seed") == 0)
+			seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> world(-500.f, 500.f);
+	std::uniform_real_distribution<float> speed(0.f, 20.f);
+	std::uniform_real_distribution<float> radius(0.f, 10.f);
+
+	const size_t maxSize = SteeringBatch::Lanes * 3 + 3;
+	SteeringBatch batch;
+	size_t checked = 0;
+
+	for (int round = 0; round < rounds; ++round)
+	{
+		for (size_t size = 1; size <= maxSize; ++size)
+		{
+			//Seek on even rounds, arrive on odd ones, with a slow radius of 0 mixed in
+			const auto seek = round % 2 == 0;
+
+			batch.Resize(size);
+			for (size_t i = 0; i < size; ++i)
+			{
+				const b2Vec2 position(world(random), world(random));
+				const auto slowRadius = seek || random() % 8 == 0 ? 0.f : radius(random);
+				batch.Set(i, position, RandomTarget(random, position), speed(random), slowRadius);
+			}
+
+			//Half the rounds start a lane in, like a population that splits its batch across threads
+			const auto begin = round % 4 >= 2 && size > SteeringBatch::Lanes ? SteeringBatch::Lanes : 0;
+			SteeringKernels::Arrive(batch, begin, size);
+
+			for (auto i = begin; i < size; ++i)
+			{
+				const auto expected = SteeringKernels::Arrive(b2Vec2(batch.PositionX[i], batch.PositionY[i]), b2Vec2(batch.TargetX[i], batch.TargetY[i]),
+					batch.MaxSpeed[i], batch.SlowRadius[i]);
+				const auto linear = batch.GetLinear(i);
+				if (!SameBits(linear.x, expected.x) || !SameBits(linear.y, expected.y))
+				{
+					fprintf(stderr, "%s mismatch at agent %zu of %zu, seed %u round %d: (%.9g, %.9g) to (%.9g, %.9g), speed %.9g, slow radius %.9g\n",
+						seek ? "Seek" : "Arrive", i, size, seed, round, batch.PositionX[i], batch.PositionY[i], batch.TargetX[i], batch.TargetY[i],
+						batch.MaxSpeed[i], batch.SlowRadius[i]);
+					fprintf(stderr, "%s gave (%.9g, %.9g), scalar gave (%.9g, %.9g)\n", SteeringKernels::InstructionSet(), linear.x, linear.y, expected.x, expected.y);
+					return 1;
+				}
+				++checked;
+			}
+
+			//The padding lanes stand still
+			for (auto i = size; i < batch.LinearX.size(); ++i)
+			{
+				if (batch.LinearX[i] != 0.f || batch.LinearY[i] != 0.f)
+				{
+					fprintf(stderr, "Padding lane %zu of %zu moved, seed %u round %d\n", i, size, seed, round);
+					return 1;
+				}
+			}
+		}
+	}
+
+	printf("%s matches scalar on %zu agents, batches of 1 to %zu\n", SteeringKernels::InstructionSet(), checked, maxSize);
+	return 0;
+}
@@ -0,0 +1,291 @@
+#include "stdafx.h"
+#include "ZombieAgent.h"
+
+#include "AI/BehaviourTree/Behaviours.h"
+#include "AI/BehaviourTree/ZombieBehaviourTree.h"
+
+#pragma region defines
+//Define some stuff for our behavior tree to make it easier to write
+#define SEL new BehaviorSelector({
+#define SEQ new BehaviorSequence({
+#define PSEQ new BehaviorPartialSequence({
+#define ALWAYS new BehaviorAlwaysTrue({
+#define RUNGOOD new BehaviorRunningIsGood({
+#define ALL new BehaviorDoAll({
+#define COND new BehaviorConditional({
+#define ACTION new BehaviorAction({
+#define ACTIONFAIL new BehaviorActionInverse({
+#define END }),
+#pragma endregion
+
+size_t ZombieAgent::s_ArenaSize = 0;
+
+ZombieAgent::ZombieAgent(IAgentHost* pHost)
+	: m_pHost(pHost)
+{
+}
+
+ZombieAgent::~ZombieAgent()
+{
+#if BEHAVIOURTREE_MODE == BEHAVIOURTREE_DYNAMIC
+	//Delete behaviortree, which will delete the rootaction and the blackboard
+	if (m_pBehaviourTree) delete m_pBehaviourTree;
+#endif
+
+	//Everything else lives in the arena, the constraint still refers to our enemies so it goes first
+	m_Arena.Release();
+}
+
+void ZombieAgent::Start(const WorldInfo* pWorldInfo)
+{
+	//Get the agent info
+	auto agentInfo = m_pHost->AGENT_GetInfo();
+
+	//Every agent is made of the same objects, after the first one it takes a single allocation
+	m_Arena.Reserve(s_ArenaSize);
+
+#pragma region StartSteering
+	//Create our steeringbehaviours and whatnot
+	m_pSeekBehaviour = m_Arena.New<SteeringBehaviours::Seek>();
+	m_pLookAroundBehaviour = m_Arena.New<SteeringBehaviours::LookAround>();
+	m_pFallbackBehaviour = m_Arena.New<SteeringBehaviours::Wander>();
+	m_pFallbackBehaviour->SetWanderRadius(5.f);
+	m_pArriveBehaviour = m_Arena.New<SteeringBehaviours::Arrive>();
+	m_ArriveSlowRadius = agentInfo.GrabRange;
+	m_pArriveBehaviour->SetSlowRadius(m_ArriveSlowRadius);
+
+	SteeringBehaviours::ISteeringBehaviour* pCurrBehaviour = nullptr;
+
+	//Pipeline
+	m_pDecomposer = m_Arena.New<CombinedSB::NavMeshDecomposer>();
+	m_pActuator = m_Arena.New<CombinedSB::BasicActuator>(m_pLookAroundBehaviour);
+	m_pConstraint = m_Arena.New<CombinedSB::AvoidEnemyConstraint>(m_VecEnemies, m_VecHouses);
+	m_pTargeter = m_Arena.New<CombinedSB::FixedGoalTargeter>();
+	m_pSteeringPipeline = m_Arena.New<CombinedSB::SteeringPipeline>();
+	m_pSteeringPipeline->SetActuator(m_pActuator);
+	m_pSteeringPipeline->SetDecomposers({ m_pDecomposer });
+	m_pSteeringPipeline->SetFallBack(m_pFallbackBehaviour);
+	m_pSteeringPipeline->SetConstraints({ m_pConstraint });
+	m_pSteeringPipeline->SetTargeters({ m_pTargeter });
+
+	//Without enemies nothing needs avoiding, the path point comes from the host and the actuator steers straight at it
+	m_pDirectPipeline = m_Arena.New<CombinedSB::SteeringPipeline>();
+	m_pDirectPipeline->SetActuator(m_pActuator);
+	m_pDirectPipeline->SetFallBack(m_pFallbackBehaviour);
+	m_pDirectPipeline->SetTargeters({ m_pTargeter });
+#pragma endregion
+
+#pragma region StartBlackboard
+	//Blackboard
+#if BEHAVIOURTREE_MODE == BEHAVIOURTREE_DYNAMIC
+	//The dynamic tree deletes the blackboard itself, it can't live in the arena
+	m_pBlackboard = new AgentBlackboard();
+#else
+	m_pBlackboard = m_Arena.New<AgentBlackboard>();
+#endif
+	auto pBoard = m_pBlackboard;
+
+	pBoard->ChangeData(Keys::Host, m_pHost);
+
+	//Steering behaviours
+	pBoard->ChangeData(Keys::WanderBehaviour, m_pFallbackBehaviour);
+	pBoard->ChangeData(Keys::SeekBehaviour, m_pSeekBehaviour);
+	pBoard->ChangeData(Keys::LookAroundBehaviour, m_pLookAroundBehaviour);
+	pBoard->ChangeData(Keys::ArriveBehaviour, m_pArriveBehaviour);
+	pBoard->ChangeData(Keys::CurrentBehaviour, pCurrBehaviour);
+	pBoard->ChangeData(Keys::Target, b2Vec2_zero);
+
+	//World info and agent info
+	pBoard->ChangeData(Keys::WorldInfo, pWorldInfo);
+	pBoard->ChangeData(Keys::AgentInfo, AgentInfo());
+	pBoard->ChangeData(Keys::Vitals, AgentVitals());
+
+	//Discovery
+	pBoard->ChangeData(Keys::LastDiscovery, 0.f);
+
+	//Houses
+	pBoard->ChangeData(Keys::HouseLocations, HouseRegistry());
+	pBoard->ChangeData(Keys::CurrentHouse, HouseHandle());
+	pBoard->ChangeData(Keys::HouseEntrance, b2Vec2_zero);
+
+	//Items
+	pBoard->ChangeData(Keys::Items, ItemStore());
+	pBoard->ChangeData(Keys::TargetItem, TargetItem());
+	pBoard->Borrow(Keys::Inventory)->Sync(m_pHost);
+
+	//Enemies
+	pBoard->ChangeData(Keys::Enemies, vector<EntityInfo>{});
+	pBoard->ChangeData(Keys::EnemySightings, 0u);
+#pragma endregion
+
+#pragma region StartBehaviourTree
+#if BEHAVIOURTREE_MODE == BEHAVIOURTREE_STATIC
+	//The static tree is already built, just start it fresh
+	m_StaticBehaviourTree.Reset();
+#elif BEHAVIOURTREE_MODE == BEHAVIOURTREE_FLAT || BEHAVIOURTREE_MODE == BEHAVIOURTREE_EVENT
+	//Every agent runs the same compiled image, only its running state is its own
+	m_pFlatBehaviourTree = m_Arena.New<FlatBehaviorTree>(GetZombieTreeImage());
+#if BEHAVIOURTREE_MODE == BEHAVIOURTREE_EVENT
+	m_pFlatBehaviourTree->SetEventDriven(true, ZombieInterruptSlots());
+#endif
+#else
+	//Make the behaviourtree
+	m_pBehaviourTree = new BehaviorTree(m_pBlackboard,
+	{
+#include "ZombieBehaviourTree.inl"
+	});
+#endif
+#pragma endregion
+
+	s_ArenaSize = std::max(s_ArenaSize, m_Arena.Used());
+}
+
+void ZombieAgent::Perceive(const AgentInfo& agentInfo, const FrameVector<HouseInfo>& vecHouseInfo, const FrameVector<EntityInfo>& vecEntityInfo)
+{
+	//Fetch visible houses and add to list of known houses
+	CheckNewHouses(vecHouseInfo);
+	CheckForEntities(vecEntityInfo);
+
+	//Update the blackboard
+	m_pBlackboard->ChangeData(Keys::AgentInfo, agentInfo);
+}
+
+void ZombieAgent::ChangeVitals(const AgentVitals& vitals)
+{
+	m_pBlackboard->ChangeData(Keys::Vitals, vitals);
+}
+
+void ZombieAgent::Think()
+{
+	//Update the behavior tree
+#if BEHAVIOURTREE_MODE == BEHAVIOURTREE_STATIC
+	m_StaticBehaviourTree.Update(m_pBlackboard);
+#elif BEHAVIOURTREE_MODE == BEHAVIOURTREE_FLAT || BEHAVIOURTREE_MODE == BEHAVIOURTREE_EVENT
+	m_pFlatBehaviourTree->Update(m_pBlackboard);
+#else
+	m_pBehaviourTree->Update();
+#endif
+}
+
+PluginOutput ZombieAgent::Steer(float dt, AgentInfo& agentInfo, SteeringBehaviours::ISteeringBehaviour* pBehaviour, const b2Vec2& target)
+{
+	m_pActuator->SetBehaviour(pBehaviour);
+
+	//Enemies make the constraint pick detours, and the decomposer has to find the way to those
+	if (!m_VecEnemies.empty())
+	{
+		m_pTargeter->GetGoalRef() = target;
+		return m_pSteeringPipeline->CalculateSteering(dt, agentInfo);
+	}
+
+	//Same point the decomposer would ask the navmesh for, but the host can keep it
+	m_pTargeter->GetGoalRef() = m_pHost->NAVMESH_GetClosestPathPoint(target);
+	return m_pDirectPipeline->CalculateSteering(dt, agentInfo);
+}
+
+bool ZombieAgent::CanSteerBatched(const SteeringBehaviours::ISteeringBehaviour* pBehaviour, float& slowRadius) const
+{
+	if (!m_VecEnemies.empty())
+		return false;
+
+	if (pBehaviour == m_pSeekBehaviour)
+		slowRadius = 0.f;
+	else if (pBehaviour == m_pArriveBehaviour)
+		slowRadius = m_ArriveSlowRadius;
+	else
+		return false;
+
+	return true;
+}
+
+PluginOutput ZombieAgent::SteerBatched(const b2Vec2& linearVelocity) const
+{
+	PluginOutput output = {};
+	output.LinearVelocity = linearVelocity;
+	output.AngularVelocity = 0.f;
+	output.AutoOrientate = true;
+	output.RunMode = m_pBlackboard->View(Keys::AgentInfo).RunMode;
+	return output;
+}
+
+AgentLod ZombieAgent::GetLod(const AgentInfo& agentInfo) const
+{
+	if (agentInfo.Bitten || m_EnemyGrid.AnyInRadius(agentInfo.Position, EnemyCriticalRadius))
+		return AgentLod::Critical;
+	if (m_SeesItem || !m_EnemyGrid.Empty())
+		return AgentLod::Active;
+	return AgentLod::Idle;
+}
+
+#pragma region House behaviour and code
+void ZombieAgent::CheckNewHouses(const FrameVector<HouseInfo>& vecHouseInfo)
+{
+	//Check if any new houses in here
+	if (vecHouseInfo.size() <= 0) return;
+
+	//Known houses are changed in place, but only borrowed when there's a new one
+	//Borrowing counts as a change, and the tree re-checks its house branch on every change
+	auto pBoard = m_pBlackboard;
+
+	//Go through every detected house, only add the ones we don't know about yet
+	for (const auto& houseInfo : vecHouseInfo)
+	{
+		if (pBoard->View(Keys::HouseLocations).Find(houseInfo.Center).IsValid())
+			continue;
+
+		pBoard->Borrow(Keys::HouseLocations)->Add(houseInfo);
+		LOG_INFO(LogCategory::House, "Adding a new house to vec of house locations.");
+	}
+}
+#pragma endregion
+
+#pragma region Entity checking
+void ZombieAgent::CheckForEntities(const FrameVector<EntityInfo>& vecEntityInfo)
+{
+	m_SeesItem = false;
+
+	//Items we know the location of are changed in place, only borrowed when there's a new one
+	auto pBoard = m_pBlackboard;
+	auto enemies = m_FrameArena.Vector<EntityInfo>();
+
+	//Loop through the entities, add any new items ones
+	for (const auto& it : vecEntityInfo)
+	{
+		switch (it.Type)
+		{
+		case ITEM:
+			m_SeesItem = true;
+
+			//Only remember new items
+			if (!pBoard->View(Keys::Items).Contains(it.Position))
+			{
+				pBoard->Borrow(Keys::Items)->Add(it);
+				LOG_INFO(LogCategory::Item, "Encountered new item.");
+			}
+			break;
+		case ENEMY:
+			//Replace enemies because they move anyway
+			enemies.push_back(it);
+			break;
+		}
+	}
+
+	//Copied over the ones of last frame, the entry keeps its storage
+	//Left alone while there's none in view and none were before, borrowing it counts as a change
+	if (!enemies.empty() || !pBoard->View(Keys::Enemies).empty())
+		pBoard->Borrow(Keys::Enemies)->assign(enemies.begin(), enemies.end());
+
+	//Another enemy came into view or one dropped out, the tree drops whatever it was doing to react
+	//Also when nothing is in view, so the level of detail drops back once they're gone
+	if (m_EnemyGrid.Update(pBoard->View(Keys::Enemies)))
+		pBoard->ChangeData(Keys::EnemySightings, pBoard->View(Keys::EnemySightings) + 1);
+
+	//Nothing in view, the enemies we saw last are still the ones the pipeline avoids
+	if (vecEntityInfo.empty()) return;
+
+	//The avoid constraint checks the path against them, one far away can still be on it
+	m_VecEnemies.clear();
+	for (const auto& enemy : pBoard->View(Keys::Enemies))
+		m_VecEnemies.push_back(enemy.Position);
+}
+#pragma endregion
@@ -0,0 +1,113 @@
+#pragma once
+#include "stdafx.h"
+#include "AgentHost.h"
+#include "Blackboard.h"
+#include "AgentBlackboard.h"
+#include "BehaviorTree.h"
+#include "FlatBehaviorTree.h"
+#include "ZombieStaticTree.h"
+#include "EnemyGrid.h"
+#include "FrameBudget.h"
+#include "FrameArena.h"
+#include "AgentArena.h"
+#include "AI/SteeringBehaviours/CombinedSB_PipelineImpl.h"
+
+#pragma region defines
+//Which tree ticks the agent
+//Dynamic: the heap-allocated BehaviorTree built in Start
+//Static: the template-composed tree from ZombieStaticTree.h
+//Flat: the tree from ZombieBehaviourTree.inl, compiled into one contiguous node array
+//Event: the flat tree, resuming its running leaf until something it depends on changes
+#define BEHAVIOURTREE_DYNAMIC 0
+#define BEHAVIOURTREE_STATIC 1
+#define BEHAVIOURTREE_FLAT 2
+#define BEHAVIOURTREE_EVENT 3
+#define BEHAVIOURTREE_MODE BEHAVIOURTREE_EVENT
+#pragma endregion
+
+/*
+ * ZOMBIE AGENT
+ * One survivor: its blackboard, behaviour tree and steering pipeline
+ * Everything it needs from the world goes through its host, so any number of them can live in one process
+ * Split in steps so a population can run each step for all of its agents before moving on to the next one
+ * Agents don't share anything they change, so different agents can be stepped on different threads
+ */
+class ZombieAgent final
+{
+public:
+	explicit ZombieAgent(IAgentHost* pHost);
+	~ZombieAgent();
+
+	ZombieAgent(const ZombieAgent&) = delete;
+	ZombieAgent& operator=(const ZombieAgent&) = delete;
+
+	//Make the steering pipeline, blackboard and behaviour tree
+	//The world info is shared with every other agent in the same world and has to outlive the agent
+	void Start(const WorldInfo* pWorldInfo);
+
+	//Remember new houses and items, keep track of enemies
+	void Perceive(const AgentInfo& agentInfo, const FrameVector<HouseInfo>& vecHouseInfo, const FrameVector<EntityInfo>& vecEntityInfo);
+	//Only call when the vitals changed, the tree re-checks our stats every time they do
+	void ChangeVitals(const AgentVitals& vitals);
+	//Tick the behaviour tree
+	void Think();
+	//Steer towards the target with the given behaviour, around walls through the host's navmesh and around enemies in view
+	PluginOutput Steer(float dt, AgentInfo& agentInfo, SteeringBehaviours::ISteeringBehaviour* pBehaviour, const b2Vec2& target);
+	//Whether the steering kernels can stand in for the pipeline this frame, and with which slow radius
+	//Only when the behaviour is our seek or arrive and there's no enemy close enough for the pipeline to avoid
+	bool CanSteerBatched(const SteeringBehaviours::ISteeringBehaviour* pBehaviour, float& slowRadius) const;
+	//Output for a linear velocity the steering kernels worked out
+	PluginOutput SteerBatched(const b2Vec2& linearVelocity) const;
+	//How much it needs the tree and steering this frame, from what it perceived last
+	AgentLod GetLod(const AgentInfo& agentInfo) const;
+
+	IAgentHost* GetHost() const { return m_pHost; }
+	AgentBlackboard* GetBlackboard() const { return m_pBlackboard; }
+	FlatBehaviorTree* GetFlatBehaviourTree() const { return m_pFlatBehaviourTree; }
+	//For whatever is dead by the end of the frame, reset by whoever runs the frame
+	FrameArena& GetFrameArena() { return m_FrameArena; }
+
+private:
+	void CheckNewHouses(const FrameVector<HouseInfo>& vecHouseInfo);
+	void CheckForEntities(const FrameVector<EntityInfo>& vecEntityInfo);
+
+	//Arena size the agents so far needed, agents are only started from one thread at a time
+	static size_t s_ArenaSize;
+
+	IAgentHost* m_pHost;
+	//Owns the steering objects, the blackboard and the flat tree
+	AgentArena m_Arena;
+	AgentBlackboard* m_pBlackboard = nullptr;
+
+	//Behaviour trees, only the one picked by BEHAVIOURTREE_MODE is used
+	BehaviorTree* m_pBehaviourTree = nullptr;
+	StaticTree::BehaviorTree<StaticTree::ZombieRoot> m_StaticBehaviourTree;
+	FlatBehaviorTree* m_pFlatBehaviourTree = nullptr;
+
+	//Steering behaviours
+	SteeringBehaviours::Seek* m_pSeekBehaviour = nullptr;
+	SteeringBehaviours::LookAround* m_pLookAroundBehaviour = nullptr;
+	SteeringBehaviours::Wander* m_pFallbackBehaviour = nullptr;
+	SteeringBehaviours::Arrive* m_pArriveBehaviour = nullptr;
+	float m_ArriveSlowRadius = 0.f;
+
+	//Steering pipeline
+	CombinedSB::NavMeshDecomposer* m_pDecomposer = nullptr;
+	CombinedSB::BasicActuator* m_pActuator = nullptr;
+	CombinedSB::AvoidEnemyConstraint* m_pConstraint = nullptr;
+	CombinedSB::FixedGoalTargeter* m_pTargeter = nullptr;
+	CombinedSB::SteeringPipeline* m_pSteeringPipeline = nullptr;
+	CombinedSB::SteeringPipeline* m_pDirectPipeline = nullptr;	//Same actuator and targeter, without decomposer or constraint
+
+	//Enemies closer than this make the agent critical for the frame budget
+	static constexpr float EnemyCriticalRadius = 15.f;
+
+	//Every enemy in view, tells when another set of them came into view
+	EnemyGrid m_EnemyGrid;
+	//Avoided by the pipeline, every enemy in view since the constraint checks them against the whole path
+	vector<b2Vec2> m_VecEnemies;
+	vector<HouseInfo> m_VecHouses;
+	bool m_SeesItem = false;	//An item was in view last time it perceived
+
+	FrameArena m_FrameArena;
+};
@@ -0,0 +1,166 @@
+#include "stdafx.h"
+#include "ZombieBehaviourTree.h"
+#include "FlatTreeImage.h"
+
+#include "AI/BehaviourTree/Behaviours.h"
+
+#pragma region defines
+//Same node macros as the dynamic tree, but they build a description instead of heap nodes
+#define SEL FlatTreeNode(FlatNodeKind::Selector, {
+#define SEQ FlatTreeNode(FlatNodeKind::Sequence, {
+#define PSEQ FlatTreeNode(FlatNodeKind::PartialSequence, {
+#define ALWAYS FlatTreeNode(FlatNodeKind::AlwaysTrue, {
+#define RUNGOOD FlatTreeNode(FlatNodeKind::RunningIsGood, {
+#define ALL FlatTreeNode(FlatNodeKind::DoAll, {
+#define COND FlatTreeNode::Leaf(FlatNodeKind::Conditional, {
+#define ACTION FlatTreeNode::Leaf(FlatNodeKind::Action, {
+#define ACTIONFAIL FlatTreeNode::Leaf(FlatNodeKind::ActionInverse, {
+#define END }),
+#pragma endregion
+
+#pragma region Leaves
+//Name of every leaf and the entries it depends on, a branch is only re-checked when one of these changed
+//Leaves without watches depend on nothing that changes outside the tree
+//Conditions also carry their inputs from Behaviours.h, the tree memoizes them on those
+namespace
+{
+	//Also what a saved image refers to its leaves by, their order here is part of the image
+	const FlatLeafRegistry::Condition s_Conditions[] =
+	{
+		//Stats
+		{ IsHealthCritical, "IsHealthCritical", SlotMask(Keys::Vitals), ConditionInputs::IsHealthCritical },
+		{ IsEnergyCritical, "IsEnergyCritical", SlotMask(Keys::Vitals), ConditionInputs::IsEnergyCritical },
+		{ NotMaxHealth, "NotMaxHealth", SlotMask(Keys::Vitals), ConditionInputs::NotMaxHealth },
+		{ NotMaxEnergy, "NotMaxEnergy", SlotMask(Keys::Vitals), ConditionInputs::NotMaxEnergy },
+
+		//Items
+		{ HasTargetItem, "HasTargetItem", SlotMask(Keys::TargetItem), ConditionInputs::HasTargetItem },
+
+		//Houses
+		{ HasTargetHouse, "HasTargetHouse", SlotMask(Keys::CurrentHouse, Keys::HouseLocations), ConditionInputs::HasTargetHouse },
+		{ InsideTargetHouse, "InsideTargetHouse", SlotMask(Keys::CurrentHouse), ConditionInputs::InsideTargetHouse },
+		{ HouseBigEnough, "HouseBigEnough", 0, ConditionInputs::HouseBigEnough },
+		{ NoDiscoveryInTime, "NoDiscoveryInTime", 0, ConditionInputs::NoDiscoveryInTime },
+	};
+
+	const FlatLeafRegistry::Action s_Actions[] =
+	{
+		//Stats
+		{ UseAnyHealthKit, "UseAnyHealthKit", SlotMask(Keys::Vitals, Keys::Inventory) },
+		{ UseAnyFood, "UseAnyFood", SlotMask(Keys::Vitals, Keys::Inventory) },
+		{ UseBestHealthKit, "UseBestHealthKit", SlotMask(Keys::Vitals, Keys::Inventory) },
+		{ UseBestFood, "UseBestFood", SlotMask(Keys::Vitals, Keys::Inventory) },
+
+		//Items
+		{ PickupItem, "PickupItem", SlotMask(Keys::TargetItem) },
+		{ SpotNewItem, "SpotNewItem", SlotMask(Keys::Items) },
+		{ SetItemAsTarget, "SetItemAsTarget", SlotMask(Keys::TargetItem) },
+
+		//Houses
+		{ SetTargetHouse, "SetTargetHouse", SlotMask(Keys::HouseLocations) },
+		{ SetHouseAsTarget, "SetHouseAsTarget", SlotMask(Keys::CurrentHouse) },
+		{ CheckHouseCenter, "CheckHouseCenter", 0 },
+		{ CheckTopLeftCorner, "CheckTopLeftCorner", 0 },
+		{ CheckTopRightCorner, "CheckTopRightCorner", 0 },
+		{ CheckBottomRightCorner, "CheckBottomRightCorner", 0 },
+		{ CheckBottomLeftCorner, "CheckBottomLeftCorner", 0 },
+		{ MarkHouseChecked, "MarkHouseChecked", 0 },
+		{ LeaveHouse, "LeaveHouse", 0 },
+		{ ResetHouses, "ResetHouses", 0 },
+
+		//World
+		{ CheckWorldTopLeft, "CheckWorldTopLeft", 0 },
+		{ CheckWorldTopRight, "CheckWorldTopRight", 0 },
+		{ CheckWorldBottomRight, "CheckWorldBottomRight", 0 },
+		{ CheckWorldBottomLeft, "CheckWorldBottomLeft", 0 },
+
+		//Movement
+		{ StartSprinting, "StartSprinting", 0 },
+		{ StopSprinting, "StopSprinting", 0 },
+		{ WanderAround, "WanderAround", 0 },
+		{ LookAroundGoToTarget, "LookAroundGoToTarget", 0 },
+		{ GoToTarget, "GoToTarget", 0 },
+		{ ArriveAtTarget, "ArriveAtTarget", 0 },
+	};
+
+	void AssignLeafInfo(FlatTreeNode& node)
+	{
+		for (const auto& entry : s_Conditions)
+		{
+			if (node.Condition == entry.Function)
+			{
+				node.Name = entry.Name;
+				node.Watches = entry.Watches;
+				node.Inputs = entry.Inputs;
+			}
+		}
+		for (const auto& entry : s_Actions)
+		{
+			if (node.Action == entry.Function)
+			{
+				node.Name = entry.Name;
+				node.Watches = entry.Watches;
+			}
+		}
+
+		for (auto& child : node.Children)
+			AssignLeafInfo(child);
+	}
+
+	//Shared by every agent, loaded or built before the first one starts
+	FlatTreeImage s_TreeImage;
+}
+#pragma endregion
+
+FlatTreeNode BuildZombieBehaviourTree()
+{
+	FlatTreeNode root[] =
+	{
+#include "ZombieBehaviourTree.inl"
+	};
+
+	AssignLeafInfo(root[0]);
+	return root[0];
+}
+
+BlackboardSlotMask ZombieInterruptSlots()
+{
+	return SlotMask(Keys::EnemySightings);
+}
+
+const FlatLeafRegistry& ZombieLeafRegistry()
+{
+	static const auto s_Registry = []
+	{
+		FlatLeafRegistry registry;
+		for (const auto& entry : s_Conditions)
+			registry.Add(entry);
+		for (const auto& entry : s_Actions)
+			registry.Add(entry);
+		return registry;
+	}();
+	return s_Registry;
+}
+
+ZombieTreeImageStatus LoadZombieTreeImage(const string& path, FlatTreeImageError* pLoadError)
+{
+	const auto description = BuildZombieBehaviourTree();
+	const auto sourceHash = FlatTreeImage::DescriptionHash(description);
+	if (s_TreeImage.Load(path, ZombieLeafRegistry(), sourceHash, pLoadError))
+		return ZombieTreeImageStatus::Mapped;
+
+	//Missing or out of date, build it and save it for the next run
+	if (!s_TreeImage.Build(description, ZombieLeafRegistry(), sourceHash))
+		return ZombieTreeImageStatus::NotBuilt;
+	return s_TreeImage.Save(path) ? ZombieTreeImageStatus::Rebuilt : ZombieTreeImageStatus::NotSaved;
+}
+
+const FlatTreeImage* GetZombieTreeImage()
+{
+	if (!s_TreeImage.IsValid())
+	{
+		const auto description = BuildZombieBehaviourTree();
+		s_TreeImage.Build(description, ZombieLeafRegistry(), FlatTreeImage::DescriptionHash(description));
+	}
+	return &s_TreeImage;
+}
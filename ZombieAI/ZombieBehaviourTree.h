@@ -0,0 +1,32 @@
+#pragma once
+#include "stdafx.h"
+#include "FlatBehaviorTree.h"
+
+class FlatLeafRegistry;
+class FlatTreeImage;
+enum class FlatTreeImageError : uint8_t;
+
+//What LoadZombieTreeImage did
+enum class ZombieTreeImageStatus
+{
+	Mapped,	//The saved image was up to date
+	Rebuilt,	//It wasn't, it was built again and saved
+	NotSaved,	//Built again, but it couldn't be saved, the agents share the one in memory
+	NotBuilt	//The tree couldn't be compiled at all
+};
+
+//Description of the agent's behaviour tree (ZombieBehaviourTree.inl), to compile into a FlatBehaviorTree
+FlatTreeNode BuildZombieBehaviourTree();
+
+//Entries that restart the tree from the root whenever they change, like a new enemy coming into view
+BlackboardSlotMask ZombieInterruptSlots();
+
+//Every condition and action of Behaviours.h the tree uses, in the order a saved image refers to them
+const FlatLeafRegistry& ZombieLeafRegistry();
+
+//Maps the compiled tree saved at path, or compiles it and saves it there when it's missing or out of date
+//Call it before the first agent starts, pLoadError gets why the saved image couldn't be used when it wasn't
+ZombieTreeImageStatus LoadZombieTreeImage(const string& path, FlatTreeImageError* pLoadError = nullptr);
+
+//Compiled tree every agent runs, built in memory on first use unless one was loaded
+const FlatTreeImage* GetZombieTreeImage();
@@ -0,0 +1,140 @@
+//Behaviour tree of the agent, written with the SEL/SEQ/PSEQ/... node macros
+//Included wherever the tree is built, each place defines the macros for the kind of tree it builds
+SEQ
+	//Always assume it's safe to stop sprinting, this will be changed in the same frame if it isn't and thus be fine
+	ALWAYS
+		ACTION(StopSprinting) END 
+	END
+
+	SEL
+		//Use items if we need them, check our stats
+		#pragma region UseHealthAndFoodIfCritical
+		ALL
+			//Health if we need it
+			SEQ
+				COND(IsHealthCritical) END
+				ACTIONFAIL(UseAnyHealthKit) END
+				//We're in trouble now, sprint!
+				ACTION(StartSprinting) END
+			END
+
+			//Energy if we need it
+			SEQ
+				COND(IsEnergyCritical) END
+				ACTIONFAIL(UseAnyFood) END
+				//We're in trouble now, sprint!
+				ACTION(StartSprinting) END
+			END
+		END
+		#pragma endregion
+
+		//Otherwise, use the best medkit or food that doesn't waste any of it
+		#pragma region UseBestAvailableFoodOrHealth
+		SEQ
+			ALWAYS
+				COND(NotMaxHealth) END
+				ACTION(UseBestHealthKit) END
+			END
+			ALWAYS
+				COND (NotMaxEnergy) END
+				ACTION(UseBestFood) END
+			END
+		END
+		#pragma endregion
+	END
+
+	SEL
+		SEL
+			SEL
+				//Picking up items
+				#pragma region Picking up items
+				SEQ
+					SEL
+						//Always look for items when we're moving, even if we're going to a house
+						//If we happen to walk by something, it might be useful and we may need it
+						PSEQ
+							COND(HasTargetItem) END
+							ACTION(PickupItem) END
+						END
+					
+						//See if there were any items we spotted before
+						ACTION(SpotNewItem) END
+					END
+
+					//Set item as target
+					ACTION(SetItemAsTarget) END
+					//Go to target
+					ACTION(GoToTarget) END
+				END
+				#pragma endregion
+
+				//House-checking
+				#pragma region Going into houses and searching them
+				SEL
+					//If we have a target house	
+					SEQ
+						COND(HasTargetHouse) END
+						SEL
+							//If we were checking one, keep checking
+							PSEQ
+								COND(InsideTargetHouse) END //If we're inside the target house
+								SEQ
+									//Go to the target
+									ACTION(LookAroundGoToTarget) END
+
+									//Sprint for faster searching
+									ACTION(StartSprinting) END
+
+									//Keep checking the house
+									PSEQ
+										//Check center
+										ACTION(CheckHouseCenter) END
+										//If the house is big enough, check corners
+										//COND(HouseBigEnough) END
+										ACTION(CheckTopLeftCorner) END
+										ACTION(CheckTopRightCorner) END
+										ACTION(CheckBottomRightCorner) END
+										ACTION(CheckBottomLeftCorner) END
+									END
+								END
+								ACTION(LeaveHouse) END //Get out of this house
+								ACTION(MarkHouseChecked) END //Mark the house checked
+							END
+
+							//Otherwise, go to our target house
+							ACTION(SetHouseAsTarget) END
+						END
+
+						//Go to our target
+						ACTION(GoToTarget) END
+					END
+
+					//Otherwise, find one
+					ACTION(SetTargetHouse) END
+				END
+				#pragma endregion
+			END
+
+			//World searching
+			SEQ
+				RUNGOOD
+					PSEQ
+						ACTION(CheckWorldTopLeft) END
+						ACTION(CheckWorldTopRight) END
+						ACTION(CheckWorldBottomLeft) END
+						ACTION(CheckWorldBottomRight) END
+						ACTION(ResetHouses) END
+					END
+				END
+
+				ACTION(LookAroundGoToTarget) END
+			END
+		END
+
+		//If we haven't found anything in the last x seconds
+		//Go back to an old house in the hopes something respawned there
+
+		//Wander if all else fails
+		ACTION(WanderAround) END
+	END
+END
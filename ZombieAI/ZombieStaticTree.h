@@ -0,0 +1,91 @@
+#pragma once
+#include "stdafx.h"
+#include "StaticBehaviorTree.h"
+#include "Behaviours.h"
+
+//Same tree as ZombieBehaviourTree.inl, composed at compile time
+//Conditions with inputs are memoized on them, like in the flat tree
+namespace StaticTree
+{
+	typedef Sequence<
+		//Always assume it's safe to stop sprinting
+		AlwaysTrue<
+			Action<StopSprinting>
+		>,
+
+		Selector<
+			//Use items if we need them, check our stats
+			DoAll<
+				Sequence<MemoCond<IsHealthCritical, ConditionInputs::IsHealthCritical>, ActionInverse<UseAnyHealthKit>, Action<StartSprinting>>,
+				Sequence<MemoCond<IsEnergyCritical, ConditionInputs::IsEnergyCritical>, ActionInverse<UseAnyFood>, Action<StartSprinting>>
+			>,
+
+			//Otherwise, use the best medkit or food that doesn't waste any of it
+			Sequence<
+				AlwaysTrue<MemoCond<NotMaxHealth, ConditionInputs::NotMaxHealth>, Action<UseBestHealthKit>>,
+				AlwaysTrue<MemoCond<NotMaxEnergy, ConditionInputs::NotMaxEnergy>, Action<UseBestFood>>
+			>
+		>,
+
+		Selector<
+			Selector<
+				Selector<
+					//Picking up items
+					Sequence<
+						Selector<
+							PartialSequence<MemoCond<HasTargetItem, ConditionInputs::HasTargetItem>, Action<PickupItem>>,
+							Action<SpotNewItem>
+						>,
+						Action<SetItemAsTarget>,
+						Action<GoToTarget>
+					>,
+
+					//House-checking
+					Selector<
+						Sequence<
+							MemoCond<HasTargetHouse, ConditionInputs::HasTargetHouse>,
+							Selector<
+								PartialSequence<
+									Cond<InsideTargetHouse>,
+									Sequence<
+										Action<LookAroundGoToTarget>,
+										Action<StartSprinting>,
+										PartialSequence<
+											Action<CheckHouseCenter>,
+											Action<CheckTopLeftCorner>,
+											Action<CheckTopRightCorner>,
+											Action<CheckBottomRightCorner>,
+											Action<CheckBottomLeftCorner>
+										>
+									>,
+									Action<LeaveHouse>,
+									Action<MarkHouseChecked>
+								>,
+								Action<SetHouseAsTarget>
+							>,
+							Action<GoToTarget>
+						>,
+						Action<SetTargetHouse>
+					>
+				>,
+
+				//World searching
+				Sequence<
+					RunningIsGood<
+						PartialSequence<
+							Action<CheckWorldTopLeft>,
+							Action<CheckWorldTopRight>,
+							Action<CheckWorldBottomLeft>,
+							Action<CheckWorldBottomRight>,
+							Action<ResetHouses>
+						>
+					>,
+					Action<LookAroundGoToTarget>
+				>
+			>,
+
+			//Wander if all else fails
+			Action<WanderAround>
+		>
+	> ZombieRoot;
+}